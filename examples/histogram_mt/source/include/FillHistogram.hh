@@ -12,7 +12,6 @@
 #include <anlnext/BasicModule.hh>
 
 class TH1;
-class GenerateEvents;
 
 
 class FillHistogram : public anlnext::BasicModule
@@ -39,7 +38,7 @@ private:
   
   TH1* spectrum_ = nullptr;
 
-  const GenerateEvents* event_ = nullptr;
+  anlnext::EventDataHandle<std::vector<double>> energies_;
 };
 
 #endif /* FillHistogram_H */
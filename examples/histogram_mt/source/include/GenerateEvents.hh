@@ -31,14 +31,11 @@ public:
   anlnext::ANLStatus mod_analyze() override;
   anlnext::ANLStatus mod_end_run() override;
 
-  const std::vector<double>& Energies() const
-  { return energies_generated_; }
-
 private:
   double center_;
   double sigma_;
-  std::vector<double> energies_generated_;
   double efficiency_;
+  anlnext::EventDataHandle<std::vector<double>> energies_;
   int num_detectors_;
   int random_seed_;
   std::unique_ptr<TRandom> random_;
@@ -1,6 +1,5 @@
 #include "FillHistogram.hh"
 #include "TH1.h"
-#include "GenerateEvents.hh"
 #include "CreateRootFile.hh"
 
 using namespace anlnext;
@@ -8,6 +7,8 @@ using namespace anlnext;
 FillHistogram::FillHistogram() :
   nbins_(128), energy0_(0.0), energy1_(100.0)
 {
+  // adding histograms is associative; the clones can be merged in parallel.
+  set_associative_merge();
 }
 
 ANLStatus FillHistogram::mod_define()
@@ -24,7 +25,7 @@ ANLStatus FillHistogram::mod_define()
 
 ANLStatus FillHistogram::mod_initialize()
 {
-  get_module("GenerateEvents", &event_);
+  energies_ = event_data_handle<std::vector<double>>("GenerateEvents:Energies");
 
   if (exist_module("CreateRootFile")) {
     comptonsoft::CreateRootFile* fileManager = nullptr;
@@ -39,9 +40,12 @@ ANLStatus FillHistogram::mod_initialize()
 
 ANLStatus FillHistogram::mod_analyze()
 {
-  const std::vector<double>& energies = event_->Energies();
+  const std::vector<double>* energies = event_data(energies_);
+  if (energies == nullptr) {
+    return AS_OK;
+  }
 
-  for (const auto& energy: energies) {
+  for (const auto& energy: *energies) {
     spectrum_->Fill(energy);
   }
 
@@ -13,6 +13,7 @@ GenerateEvents::GenerateEvents()
 GenerateEvents::GenerateEvents(const GenerateEvents& r)
   : BasicModule::BasicModule(r),
     center_(r.center_), sigma_(r.sigma_), efficiency_(r.efficiency_),
+    energies_(r.energies_),
     num_detectors_(r.num_detectors_), random_seed_(r.random_seed_),
     random_(nullptr),
     sum_events_(r.sum_events_)
@@ -29,13 +30,15 @@ ANLStatus GenerateEvents::mod_define()
   define_parameter("num_detectors", &mod_class::num_detectors_);
   define_parameter("random_seed", &mod_class::random_seed_);
 
+  // the energies of each event are passed to the following modules.
+  energies_ = define_event_data<std::vector<double>>("GenerateEvents:Energies");
+
   return AS_OK;
 }
 
 ANLStatus GenerateEvents::mod_initialize()
 {
   random_.reset(new TRandom3(random_seed_+copy_id()));
-  energies_generated_.reserve(num_detectors_);
 
   define_evs("GenerateEvents:Hit");
 
@@ -50,17 +53,18 @@ ANLStatus GenerateEvents::mod_begin_run()
 
 ANLStatus GenerateEvents::mod_analyze()
 {
-  energies_generated_.clear();
+  std::vector<double>& energies = publish_event_data(energies_);
+  energies.clear();
 
   for (int i=0; i<num_detectors_; i++) {
     const double energy = random_->Gaus(center_, sigma_);
     if (random_->Uniform(1.0) < efficiency_) {
-      energies_generated_.push_back(energy);
+      energies.push_back(energy);
       ++sum_events_;
     }
   }
 
-  if (energies_generated_.size() > 0) {
+  if (energies.size() > 0) {
     set_evs("GenerateEvents:Hit");
   }
   
@@ -0,0 +1,67 @@
+/**
+ * Scaling benchmark of the multi-thread mode.
+ *
+ * The analysis chain consists of MyMTModule, whose mod_analyze() does
+ * almost nothing, so the measured rate shows the overhead of the framework
+ * itself, i.e., the loop index dispatching and the per-chain counters.
+ *
+ * usage: mt_scaling_benchmark [number_of_events] [max_threads] [chunk_size]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <anlnext/ANLManagerMT.hh>
+#include "MyMTModule.hh"
+
+double run_benchmark(long int num_events, int num_threads, long int chunk_size)
+{
+  MyMTModule module1;
+  MyMTModule module2;
+  module2.set_module_id("MyMTModule2");
+
+  anlnext::ANLManagerMT anl(num_threads);
+  anl.set_chunk_size(chunk_size);
+  anl.set_display_period(0);
+  anl.set_modules({&module1, &module2});
+
+  // messages of the manager are discarded.
+  std::ostringstream sink;
+  std::streambuf* original = std::cout.rdbuf(sink.rdbuf());
+  anl.Define();
+  anl.PreInitialize();
+  anl.Initialize();
+  anl.Analyze(num_events, false);
+  anl.Finalize();
+  std::cout.rdbuf(original);
+
+  return anl.analysis_time();
+}
+
+int main(int argc, char** argv)
+{
+  const long int num_events = (argc > 1) ? std::stol(argv[1]) : 10000000;
+  const int max_threads = (argc > 2) ? std::stoi(argv[2]) : 64;
+  const long int chunk_size = (argc > 3) ? std::stol(argv[3]) : 256;
+
+  std::cout << "Number of events: " << num_events << '\n'
+            << "Chunk size: " << chunk_size << '\n'
+            << '\n'
+            << " threads |  time [s] |  rate [events/s] | speedup \n"
+            << "-------------------------------------------------------" << std::endl;
+
+  double time_single = 0.0;
+  for (int n=1; n<=max_threads; n*=2) {
+    const double t = run_benchmark(num_events, n, chunk_size);
+    if (n == 1) { time_single = t; }
+    std::cout << std::setw(8) << n << " | "
+              << std::setw(9) << std::fixed << std::setprecision(4) << t << " | "
+              << std::setw(16) << std::setprecision(0) << num_events/t << " | "
+              << std::setw(7) << std::setprecision(2) << time_single/t << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * Micro-benchmark of OrderKeeper (lock-free) and BlockingOrderKeeper
+ * (mutex + condition variable).
+ *
+ * Each thread takes the next index from a shared counter and passes through
+ * a KeeperBlock, as an order-sensitive module does in multi-thread mode.
+ *
+ * usage: order_keeper_benchmark [number_of_indices] [max_threads] [work]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <anlnext/OrderKeeper.hh>
+
+template <typename KeeperType>
+double run_benchmark(long int num_indices, int num_threads, int work)
+{
+  KeeperType keeper;
+  std::atomic<long int> next_index(0);
+  std::atomic<long int> checksum(0);
+
+  auto worker = [&]() {
+    while (true) {
+      const long int index = next_index.fetch_add(1);
+      if (index >= num_indices) { break; }
+
+      // parallel part of the event
+      volatile double x = 0.0;
+      for (int i=0; i<work; i++) { x = x + i; }
+
+      // order-sensitive part of the event
+      const anlnext::KeeperBlock<KeeperType, long int> block(&keeper, index);
+      checksum = checksum*31 + index;
+    }
+  };
+
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i=0; i<num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t: threads) {
+    t.join();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char** argv)
+{
+  const long int num_indices = (argc > 1) ? std::stol(argv[1]) : 200000;
+  const int max_threads = (argc > 2) ? std::stoi(argv[2]) : std::thread::hardware_concurrency();
+  const int work = (argc > 3) ? std::stoi(argv[3]) : 1000;
+
+  std::cout << "Number of indices: " << num_indices << '\n'
+            << "Work per index: " << work << '\n'
+            << '\n'
+            << " threads |   OrderKeeper [s] | BlockingOrderKeeper [s] \n"
+            << "---------------------------------------------------------" << std::endl;
+
+  for (int n=1; n<=max_threads; n*=2) {
+    const double t_lock_free = run_benchmark<anlnext::OrderKeeper>(num_indices, n, work);
+    const double t_blocking = run_benchmark<anlnext::BlockingOrderKeeper>(num_indices, n, work);
+    std::cout << std::setw(8) << n << " | "
+              << std::setw(17) << std::fixed << std::setprecision(4) << t_lock_free << " | "
+              << std::setw(23) << t_blocking << std::endl;
+  }
+
+  return 0;
+}
@@ -23,6 +23,9 @@
 #define ANLNEXT_ANALYZE_INTERRUPT 1
 #define ANLNEXT_INITIALIZE_INTERRUPT 1
 #define ANLNEXT_FINALIZE_INTERRUPT 1
+#ifndef ANLNEXT_MODULE_TIMING
+#define ANLNEXT_MODULE_TIMING 1
+#endif
 
 #include <cstddef>
 #include <iostream>
@@ -30,6 +33,7 @@
 #include <vector>
 #include <map>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <future>
 #include <boost/property_tree/ptree.hpp>
@@ -37,14 +41,19 @@
 #include "ANLStatus.hh"
 #include "ANLException.hh"
 #include "LoopCounter.hh"
+#include "ProgressReporter.hh"
 
 namespace anlnext
 {
 
 class EvsManager;
+class EventDataBus;
+class EventArena;
 class ModuleAccess;
 class BasicModule;
 class OrderKeeper;
+class CheckpointWriter;
+class CheckpointReader;
 
 /**
  * The ANL Next manager class.
@@ -57,6 +66,13 @@ class OrderKeeper;
  * @date 2017-07-07 | rename methods
  * @date 2017-07-19 | introduce user request, modify print messages.
  * @date 2019-12-25 | add module results feature
+ * @date 2026-10-18 | per-module timing profiler
+ * @date 2026-10-18 | statistics export
+ * @date 2026-10-18 | progress reporter
+ * @date 2026-10-18 | checkpoint and resume
+ * @date 2026-10-18 | batch mode
+ * @date 2026-10-18 | per-event data bus
+ * @date 2026-10-18 | per-event arena
  */
 class ANLManager
 {
@@ -84,6 +100,17 @@ public:
   void set_display_period(long int v) { display_period_ = v; }
   long int display_period() const;
 
+  /**
+   * set the interval of the progress report in seconds.
+   * A background thread reports the event rate, the estimated time to
+   * finish, and the rates of the chains. Zero disables the report.
+   * By default (negative), the multi-thread managers report every second
+   * unless the display period is zero, and the single-thread manager does
+   * not report.
+   */
+  void set_progress_report_interval(double v) { progress_report_interval_ = v; }
+  double progress_report_interval() const;
+
   void set_exception_propagation(bool v)
   { exception_propagation_ = v; }
   bool exception_propagation() const
@@ -95,7 +122,33 @@ public:
   virtual ANLStatus Analyze(long int num_events, bool enable_console=false);
   virtual ANLStatus Finalize();
 
+  /**
+   * if true, processing time of mod_analyze() is measured for each module.
+   * This takes effect at the next Analyze().
+   * The measurement is compiled out if ANLNEXT_MODULE_TIMING is 0.
+   */
+  void set_module_timing(bool v=true) { module_timing_ = v; }
+  bool module_timing() const { return module_timing_; }
+
+  /**
+   * if larger than one, the chains process the loop in batches of the given
+   * number of events, and the modules with
+   * BasicModule::set_batch_analysis() process a batch at once. The counters
+   * and the EVS counts are the same as processing one event at a time. If a
+   * module quits at an event, the following events of the batch that have
+   * been processed by earlier modules are discarded. Not used for chains
+   * with order-sensitive modules.
+   */
+  void set_batch_size(long int v) { batch_size_ = (v > 1) ? v : 0; }
+  long int batch_size() const { return batch_size_; }
+
   virtual int number_of_parallels() const { return 1; }
+
+  /**
+   * maximum distance between the loop indices that the chains may be
+   * processing at the same time. A negative value means no limit.
+   */
+  virtual long int loop_index_span() const { return 1; }
   void set_print_parallel_modules(bool v=true)
   { print_clone_parameters_ = v; }
   virtual BasicModule* access_to_module(int chain_ID,
@@ -107,6 +160,39 @@ public:
   virtual boost::property_tree::ptree parameters_to_property_tree() const;
   void parameters_to_json(const std::string& filename) const;
 
+  /**
+   * wall-clock time of the last analysis loop in seconds.
+   */
+  double analysis_time() const { return analysis_time_; }
+
+  /**
+   * get the loop counters, the EVS counts, and the throughput of the last
+   * analysis loop as a property tree.
+   * The counters and the EVS counts are accumulated since Initialize().
+   */
+  virtual boost::property_tree::ptree statistics_to_property_tree() const;
+  void statistics_to_json(const std::string& filename) const;
+
+  /**
+   * write a checkpoint to the file every given number of events of the
+   * analysis loop: the loop position, the counters, the EVS counts, and the
+   * states of the modules of all the chains (see
+   * BasicModule::mod_save_state()). The chains are synchronized at each
+   * checkpoint. Zero period (default) disables the checkpoints.
+   */
+  void set_checkpoint(const std::string& filename, long int period);
+  std::string checkpoint_file() const { return checkpoint_file_; }
+  long int checkpoint_period() const { return checkpoint_period_; }
+
+  /**
+   * restart the next Analyze() from a checkpoint file instead of the first
+   * event. Analyze() should be called with the same number of events as
+   * the run that wrote the checkpoint, and the manager must have the same
+   * modules and chains.
+   */
+  void set_resume_file(const std::string& filename) { resume_file_ = filename; }
+  std::string resume_file() const { return resume_file_; }
+
 protected:
   virtual ANLStatus routine_define();
   virtual ANLStatus routine_pre_initialize();
@@ -120,7 +206,34 @@ protected:
   virtual void print_results();
   virtual void reset_counters();
   virtual ANLStatus process_analysis();
-  void print_summary();
+  virtual void print_summary();
+  void print_timing_summary();
+  virtual double default_progress_report_interval() const { return 0.0; }
+  virtual int number_of_progress_counters() const { return 1; }
+  virtual void apply_module_timing();
+
+  /**
+   * range of loop indices [loop_begin, loop_end) that process_analysis()
+   * processes. The loop is divided into the ranges between checkpoints.
+   * loop_end is negative for an infinite loop.
+   */
+  long int loop_begin() const { return loop_begin_; }
+  long int loop_end() const { return loop_end_; }
+
+  /**
+   * called once at the start of an analysis loop, before any range of it is
+   * processed.
+   */
+  virtual void begin_analysis_loop();
+
+  /**
+   * largest memory taken from an event arena in an event, over the arenas
+   * of all the chains.
+   */
+  virtual std::size_t event_arena_peak_usage() const;
+  virtual bool is_checkpoint_supported() const { return true; }
+  virtual void write_checkpoint_chains(CheckpointWriter& writer);
+  virtual void read_checkpoint_chains(CheckpointReader& reader);
 
   int module_index(const std::string& module_id, bool strict=true) const;
 
@@ -140,6 +253,11 @@ private:
   // thread mode
 private:
   void process_analysis_for_the_thread(std::promise<ANLStatus> status_promise);
+  ANLStatus process_analysis_with_progress_report();
+  ANLStatus process_analysis_with_checkpoints();
+  ANLStatus process_analysis_in_batches();
+  void save_checkpoint();
+  void restore_checkpoint(const std::string& filename);
   void interactive_session();
 
 protected:
@@ -148,12 +266,26 @@ protected:
   std::vector<BasicModule*> modules_;
   std::vector<LoopCounter> counters_;
   std::unique_ptr<EvsManager> evs_manager_;
+  std::unique_ptr<EventDataBus> event_data_bus_;
+  std::unique_ptr<EventArena> event_arena_;
   std::mutex mutex_;
   std::atomic<ANLRequest> requested_{ANLRequest::none};
   bool exception_propagation_ = true;
+  ProgressReporter progress_;
 
 private:
   long int display_period_ = -1;
+  double progress_report_interval_ = -1.0;
+  bool module_timing_ = false;
+  long int batch_size_ = 0;
+  std::chrono::steady_clock::time_point analysis_start_;
+  double analysis_time_ = 0.0;
+  long int entries_at_start_ = 0;
+  std::string checkpoint_file_;
+  long int checkpoint_period_ = 0;
+  std::string resume_file_;
+  long int loop_begin_ = 0;
+  long int loop_end_ = 0;
   std::unique_ptr<ModuleAccess> module_access_;
   std::atomic<bool> analysis_thread_finished_{false};
 };
@@ -178,8 +310,89 @@ ANLStatus process_one_event(long int i_event,
                             EvsManager& evs_manager,
                             std::vector<std::unique_ptr<OrderKeeper>>& order_keepers);
 
+/**
+ * process modules[module_begin, module_end) for an event.
+ * Neither the loop index nor the EVS flags are touched.
+ */
+ANLStatus process_modules_in_range(long int i_event,
+                                   const std::vector<BasicModule*>& modules,
+                                   std::vector<LoopCounter>& counters,
+                                   std::size_t module_begin,
+                                   std::size_t module_end);
+
+/**
+ * process the first part of the chain, modules[0, tail_begin), for an event.
+ * The EVS flags are reset but not counted.
+ */
+ANLStatus process_one_event_head(long int i_event,
+                                 const std::vector<BasicModule*>& modules,
+                                 std::vector<LoopCounter>& counters,
+                                 EvsManager& evs_manager,
+                                 std::size_t tail_begin);
+
+/**
+ * process the rest of the chain, modules[tail_begin, end), for an event
+ * whose head has been processed with status of ok.
+ * The EVS flags are not counted.
+ */
+ANLStatus process_one_event_tail(long int i_event,
+                                 const std::vector<BasicModule*>& modules,
+                                 std::vector<LoopCounter>& counters,
+                                 std::size_t tail_begin);
+
 void count_evs(ANLStatus status, EvsManager& evs_manager);
 
+/**
+ * rewind the event arenas of the modules [module_begin, module_end).
+ * The modules of a chain usually share an arena.
+ */
+void rewind_event_arenas(const std::vector<BasicModule*>& modules,
+                         std::size_t module_begin,
+                         std::size_t module_end);
+
+/**
+ * work area of process_event_batch(), reused for the batches of a chain.
+ */
+struct EventBatch
+{
+  struct Result
+  {
+    ANLStatus status = AS_OK;
+    bool entered = false;
+    int64_t time = -1;
+  };
+
+  /** status of the chain for each event */
+  std::vector<ANLStatus> statuses;
+  std::vector<ANLStatus> module_statuses;
+  /** result of each module (major) for each event */
+  std::vector<Result> results;
+  std::vector<std::vector<uint64_t>> evs_flags;
+};
+
+/**
+ * process the events [first_index, first_index+num_events) as a batch.
+ * Runs of consecutive batch modules process the batch one module after
+ * another, and the other modules one event after another with the EVS
+ * flags of each event. The counters and the EVS counts are updated in the
+ * order of the events up to the first event that quits or fails.
+ * @return number of events whose statuses in batch.statuses are valid.
+ * An event with status of redo ends the batch, and has to be processed
+ * again before the following events.
+ */
+std::size_t process_event_batch(long int first_index,
+                                long int num_events,
+                                const std::vector<BasicModule*>& modules,
+                                std::vector<LoopCounter>& counters,
+                                EvsManager& evs_manager,
+                                EventBatch& batch);
+
+/**
+ * convert a loop counter of a module into a property tree.
+ */
+boost::property_tree::ptree module_counter_to_property_tree(const BasicModule& module,
+                                                            const LoopCounter& counter);
+
 inline void print_event_index(long int index, std::ostream& os=std::cout)
 {
   os << "Event : " << std::dec << std::setw(10) << index << std::endl;
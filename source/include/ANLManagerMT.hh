@@ -24,6 +24,12 @@
 #include <future>
 
 #include "ClonedChainSet.hh"
+#include "LoopIndexDispatcher.hh"
+#include "ReorderBuffer.hh"
+#include "BlockingQueue.hh"
+#include "ThreadAffinity.hh"
+#include "WorkerPool.hh"
+#include "PartialReducer.hh"
 
 namespace anlnext
 {
@@ -37,6 +43,18 @@ class BasicModule;
  *
  * @author Hirokazu Odaka
  * @date 2017-07-05
+ * @date 2026-10-18 | chunked dispatch of loop indices
+ * @date 2026-10-18 | work-stealing scheduler
+ * @date 2026-10-18 | reorder buffer for order-sensitive modules
+ * @date 2026-10-18 | hybrid mode with a parallel segment
+ * @date 2026-10-18 | thread affinity
+ * @date 2026-10-18 | persistent worker threads
+ * @date 2026-10-18 | parallel phase routines
+ * @date 2026-10-18 | parallel tree reduction
+ * @date 2026-10-18 | partial reduction during the analysis loop
+ * @date 2026-10-18 | checkpoints of all the chains
+ * @date 2026-10-18 | per-event data bus of each chain
+ * @date 2026-10-18 | per-event arena of each chain
  */
 class ANLManagerMT : public ANLManager
 {
@@ -45,11 +63,138 @@ public:
   virtual ~ANLManagerMT();
 
   int number_of_parallels() const override { return num_parallels_; }
+  long int loop_index_span() const override;
   BasicModule* access_to_module(int chain_ID,
                                 const std::string& module_ID) override;
 
+  /**
+   * set the number of loop indices that a chain takes at a time.
+   * Larger chunks reduce contention between threads when each event is cheap.
+   * If the chain contains an order-sensitive module, chunk size of 1 is
+   * always used.
+   */
+  void set_chunk_size(long int v) { chunk_size_ = (v > 0) ? v : 1; }
+  long int chunk_size() const { return chunk_size_; }
+
+  /**
+   * if true, the chunk size shrinks near the end of the loop so that all
+   * chains finish at nearly the same time.
+   */
+  void set_adaptive_chunk(bool v=true) { adaptive_chunk_ = v; }
+  bool is_adaptive_chunk() const { return adaptive_chunk_; }
+
+  /**
+   * if true, the loop is divided among the chains in advance, and an idle
+   * chain steals indices from busy ones. This is efficient when the cost of
+   * an event varies much. The chunk size is applied to each take from the
+   * chain's own indices. Not used for infinite loops nor for chains with
+   * order-sensitive modules.
+   */
+  void set_work_stealing(bool v=true) { work_stealing_ = v; }
+  bool is_work_stealing() const { return work_stealing_; }
+
+  /**
+   * set the number of events that can wait for the order-sensitive modules.
+   * If positive, the chain is divided at the first order-sensitive module.
+   * The first part (head) runs in parallel, and the rest (tail) runs on a
+   * dedicated thread in the order of loop indices, so that a thread does not
+   * wait for the preceding events. The given number of extra chains are
+   * cloned to hold the waiting events. This must be set before
+   * PreInitialize(). Zero (default) disables this mode.
+   */
+  void set_reorder_buffer_size(int v) { reorder_buffer_size_ = (v > 0) ? v : 0; }
+  int reorder_buffer_size() const { return reorder_buffer_size_; }
+
+  int number_of_chains() const { return 1 + cloned_chains_.size(); }
+
+  /**
+   * number of the analysis threads. The threads are created at
+   * PreInitialize() and reused by every Analyze() until the manager is
+   * destroyed. In the plain mode, thread i always processes chain i. In
+   * the reorder buffer and hybrid modes, the extra chains are shared by
+   * the threads, and a thread processes whichever chain is free; the last
+   * threads process the head and/or the tail.
+   */
+  int number_of_threads() const;
+
+  /**
+   * set the segment of the chain, from first_module_id to last_module_id
+   * (inclusive), that is processed in parallel (hybrid mode).
+   * Only the modules of the segment are cloned. The modules before the
+   * segment (head) run on a single thread that feeds events to the segment,
+   * and the modules after the segment (tail) run on another single thread in
+   * the order of loop indices. The head and tail modules need not support
+   * parallel run.
+   *
+   * Only the loop index and the EVS flags are passed between the head, the
+   * segment, and the tail; a module must not read per-event data of a module
+   * in another part. Quit from any module stops the whole loop. The number
+   * of extra chains to hold waiting events is given by
+   * set_reorder_buffer_size(), or num_parallels if it is zero.
+   * This must be set before PreInitialize().
+   */
+  void set_parallel_segment(const std::string& first_module_id,
+                            const std::string& last_module_id)
+  {
+    segment_first_module_id_ = first_module_id;
+    segment_last_module_id_ = last_module_id;
+  }
+  bool is_hybrid_mode() const { return use_hybrid_mode_; }
+
+  /**
+   * set the policy to pin the threads to CPUs: "none" (default), "compact",
+   * "scatter", or "explicit". Thread i processes chain i; in the reorder
+   * buffer or hybrid mode, the head and tail threads follow the workers.
+   * If a policy is set, the modules of each cloned chain are cloned, and
+   * run the routines such as mod_initialize(), on the pinned thread of the
+   * chain, so that their memory is allocated close to it. This must be set before
+   * PreInitialize().
+   */
+  void set_thread_affinity(const std::string& policy) { affinity_.set_policy(policy); }
+  std::string thread_affinity() const { return affinity_.policy_name(); }
+
+  /**
+   * set the CPUs for the threads in order. This selects the "explicit" policy.
+   */
+  void set_thread_affinity_cpus(const std::vector<int>& cpus)
+  {
+    affinity_.set_cpu_list(cpus);
+    affinity_.set_policy(AffinityPolicy::explicit_list);
+  }
+
+  /**
+   * if true, the cloned chains run mod_initialize(), mod_begin_run(),
+   * mod_end_run(), and mod_finalize() concurrently on their worker threads,
+   * after the master chain. The output of each chain to std::cout is
+   * buffered and printed in the order of the chains. If some chains fail,
+   * the result (status or exception) is that of the first of them, but the
+   * other chains have also run the routine. The modules must be safe to
+   * run these routines in parallel.
+   */
+  void set_parallel_routines(bool v=true) { parallel_routines_ = v; }
+  bool is_parallel_routines() const { return parallel_routines_; }
+
+  /**
+   * request a partial reduction every given number of events and/or every
+   * given time interval in seconds, so that the merged results can be seen
+   * during a long analysis loop. Only the modules with
+   * set_partial_reduction() take part; see BasicModule. Zero (default)
+   * disables each trigger. Not performed in the reorder buffer and hybrid
+   * modes.
+   */
+  void set_partial_reduction_period(long int v) { partial_reduction_period_ = (v > 0) ? v : 0; }
+  long int partial_reduction_period() const { return partial_reduction_period_; }
+  void set_partial_reduction_interval(double v) { partial_reduction_interval_ = (v > 0.0) ? v : 0.0; }
+  double partial_reduction_interval() const { return partial_reduction_interval_; }
+
+  /**
+   * number of deltas merged by the partial reduction in the last analysis loop.
+   */
+  long int number_of_merged_deltas() const { return partial_reducer_.number_of_merged_deltas(); }
+
 protected:
   void clone_modules(int chain_ID);
+  void setup_parallel_segment();
 
   ANLStatus routine_initialize() override;
   ANLStatus routine_begin_run() override;
@@ -59,28 +204,90 @@ protected:
   void print_parameters() override;
   void print_results() override;
   void reset_counters() override;
+  void print_summary() override;
+  void apply_module_timing() override;
+  double default_progress_report_interval() const override { return 1.0; }
+  int number_of_progress_counters() const override { return number_of_chains(); }
   
+  void begin_analysis_loop() override;
+  std::size_t event_arena_peak_usage() const override;
   ANLStatus process_analysis() override;
+  bool is_checkpoint_supported() const override { return !use_hybrid_mode_; }
+  void write_checkpoint_chains(CheckpointWriter& writer) override;
+  void read_checkpoint_chains(CheckpointReader& reader) override;
   virtual void process_analysis_in_each_thread(int i_thread, std::promise<ANLStatus> status_promise);
-  virtual long int event_index_to_process();
-  void decrement_event_index();
+  virtual bool event_range_to_process(int i_thread, LoopIndexRange& range);
+  bool is_order_sensitive_chain() const;
 
   boost::property_tree::ptree parameters_to_property_tree() const override;
+  boost::property_tree::ptree statistics_to_property_tree() const override;
 
 private:
   void duplicate_chains() override;
   void automatic_switch_for_singletons();
-  ANLStatus process_analysis_impl(const std::vector<BasicModule*>& modules,
+  ANLStatus process_analysis_impl(int i_thread,
+                                  const std::vector<BasicModule*>& modules,
                                   std::vector<LoopCounter>& counters,
                                   EvsManager& evs_manager);
+  bool is_batch_mode() const;
+  ANLStatus process_analysis_in_batches_impl(int i_thread,
+                                             const std::vector<BasicModule*>& modules,
+                                             std::vector<LoopCounter>& counters,
+                                             EvsManager& evs_manager);
+  ANLStatus process_analysis_head_impl(int i_thread);
+  ANLStatus process_analysis_tail_impl();
+  ANLStatus process_hybrid_head_impl(int i_thread);
+  ANLStatus process_hybrid_segment_impl();
+  ANLStatus process_hybrid_tail_impl();
+  ANLStatus treat_exception_in_analysis(ANLException& ex);
+  void abort_buffers();
+  std::vector<ANLStatus> run_analysis_threads(int num_threads);
+  void set_chain_quit(int chain_index) { quit_chains_[chain_index] = 1; }
+  bool has_chain_quit(int chain_index) const { return (quit_chains_[chain_index] != 0); }
+  bool all_chains_quit() const;
+  template <typename T> ANLStatus process_with_chain(int chain_index, T func);
+  EventDataBus& chain_event_data_bus(int chain_index);
+  EventArena& chain_event_arena(int chain_index);
+  template <typename T> void run_on_pinned_thread(int thread_index, T func);
+  void start_worker_pool();
+  template <typename T> ANLStatus routine_modfn_for_clones(T func, const std::string& func_id);
   ANLStatus reduce_modules() override;
+  ANLStatus reduce_clones_in_tree(const std::vector<BasicModule*>& clones);
+  bool is_partial_reduction_enabled() const;
+  ANLStatus detach_deltas(const std::vector<BasicModule*>& modules);
+  ANLStatus merge_deltas(int chain_index);
   void reduce_statistics() override;
 
 private:
   const int num_parallels_ = 1;
-  long int loop_index_ = -1;
+  long int chunk_size_ = 1;
+  bool adaptive_chunk_ = false;
+  bool work_stealing_ = false;
+  int reorder_buffer_size_ = 0;
+  bool use_reorder_buffer_ = false;
+  std::size_t tail_begin_ = 0;
+  std::string segment_first_module_id_;
+  std::string segment_last_module_id_;
+  bool use_hybrid_mode_ = false;
+  bool parallel_routines_ = false;
+  long int partial_reduction_period_ = 0;
+  double partial_reduction_interval_ = 0.0;
+  std::size_t segment_begin_ = 0;
+  std::size_t segment_end_ = 0;
+  ThreadAffinity affinity_;
+  WorkerPool worker_pool_;
+  PartialReducer partial_reducer_;
+  LoopIndexDispatcher dispatcher_;
+  ReorderBuffer reorder_buffer_;
+  BlockingQueue<ReorderBuffer::Entry> segment_queue_;
+  std::unique_ptr<EvsManager> head_evs_;
+  std::unique_ptr<EvsManager> tail_evs_;
+  std::unique_ptr<EventArena> tail_arena_;
   std::vector<ClonedChainSet> cloned_chains_;
+  std::vector<LoopCounter> master_counters_;
+  std::unique_ptr<EvsManager> master_evs_;
   std::vector<std::unique_ptr<OrderKeeper>> order_keepers_;
+  std::vector<char> quit_chains_;
 };
 
 } /* namespace anlnext */
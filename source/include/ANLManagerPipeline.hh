@@ -0,0 +1,127 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ANLManagerPipeline_H
+#define ANLNEXT_ANLManagerPipeline_H 1
+
+#include "ANLManager.hh"
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SPSCRingBuffer.hh"
+
+namespace anlnext
+{
+
+class EvsManager;
+class EventArena;
+class BasicModule;
+
+/**
+ * The ANL Next manager class for pipeline-parallel mode.
+ *
+ * The module chain is divided into stages, each of which runs on its own
+ * thread and passes events to the next stage through a bounded buffer.
+ * Since the modules are not cloned, this mode is available for modules that
+ * do not support parallel run, and large tables held by modules are not
+ * duplicated.
+ *
+ * Modules must follow these rules:
+ * - Different stages process different events at the same time. A module
+ *   must not read per-event data held by a module in another stage (e.g.,
+ *   through get_module()); put such modules in the same stage.
+ * - Only the loop index, the status, and the EVS flags are passed to the
+ *   next stage. The EVS flags are counted in the last stage.
+ * - The event data bus is shared by the stages; a value published by a
+ *   module can be read only by the modules in the same stage. Likewise,
+ *   each stage has its own event arena.
+ * - Redo reprocesses the event only in the stage of the module.
+ * - After quit, the following events already processed by earlier stages
+ *   are discarded.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ * @date 2026-10-18 | event arena of each stage
+ */
+class ANLManagerPipeline : public ANLManager
+{
+public:
+  ANLManagerPipeline();
+  virtual ~ANLManagerPipeline();
+
+  /**
+   * make the module the first one of a new stage.
+   * If no boundary is defined, each module forms its own stage.
+   */
+  void define_stage_boundary(const std::string& module_id);
+  void clear_stage_boundaries() { stage_boundaries_.clear(); }
+
+  /**
+   * number of stages used in the last analysis.
+   */
+  int number_of_stages() const
+  { return stage_begin_.empty() ? 0 : static_cast<int>(stage_begin_.size()-1); }
+
+  /**
+   * set the number of events that each buffer between stages can hold.
+   */
+  void set_buffer_size(std::size_t v) { buffer_size_ = (v > 0) ? v : 1; }
+  std::size_t buffer_size() const { return buffer_size_; }
+
+protected:
+  ANLStatus process_analysis() override;
+  void print_summary() override;
+  double default_progress_report_interval() const override { return 1.0; }
+  std::size_t event_arena_peak_usage() const override;
+  // the EVS counts of the stages are not kept between ranges of the loop.
+  bool is_checkpoint_supported() const override { return false; }
+
+private:
+  struct PipelineEvent
+  {
+    long int index = -1;
+    ANLStatus status = ANLStatus::ok;
+    std::vector<uint64_t> evs_flags;
+  };
+
+  void setup_stages();
+  void process_stage(int i_stage, std::promise<ANLStatus> status_promise);
+  ANLStatus process_stage_impl(int i_stage);
+  void request_quit_from(long int i_event);
+  void abort_pipeline();
+  void reduce_statistics() override;
+
+private:
+  std::vector<std::string> stage_boundaries_;
+  std::size_t buffer_size_ = 64;
+  std::vector<std::size_t> stage_begin_;
+  std::vector<std::unique_ptr<SPSCRingBuffer<PipelineEvent>>> buffers_;
+  std::vector<std::unique_ptr<EvsManager>> stage_evs_;
+  std::vector<std::unique_ptr<EventArena>> stage_arenas_;
+  std::atomic<long int> quit_index_{0};
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ANLManagerPipeline_H */
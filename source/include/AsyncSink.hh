@@ -0,0 +1,251 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_AsyncSink_H
+#define ANLNEXT_AsyncSink_H 1
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <boost/format.hpp>
+#include "BasicModule.hh"
+#include "MPSCRingBuffer.hh"
+
+namespace anlnext
+{
+
+/**
+ * Order of the records written by AsyncSink.
+ *
+ * - arrival: records are written in the order the chains make them.
+ * - loop_index: records are written in the order of the loop index. The
+ *   module is made order-sensitive, so that the manager calls it in order.
+ */
+enum class SinkOrder
+{
+  arrival, loop_index
+};
+
+/**
+ * Base class of an output module that writes the events on a background
+ * writer thread, so that the analysis chains do not wait for the output.
+ *
+ * A derived class implements serialize_event(), which is called in
+ * mod_analyze() to make a record of the event, and write_record(), which is
+ * called on the writer thread of the master with the records in order. The
+ * clones of the module push their records into the buffer of the master,
+ * which blocks while it is full. The records are all written by the end of
+ * mod_end_run() and of mod_save_state() for a checkpoint, followed by
+ * flush_output(); an exception thrown by write_record() is rethrown in the
+ * analysis loop or in these methods.
+ *
+ * write_record() and flush_output() should access only the writer-side
+ * state of the master, e.g., the output file. The writer thread is stopped
+ * by mod_end_run() or mod_finalize(). Since they are not called when the
+ * analysis fails, the destructor of a derived class must call
+ * stop_writer(), which discards the records not written yet. A derived
+ * class that overrides the mod_*() methods defined here should call them
+ * of this class.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ * @date 2026-10-18 | records written at checkpoints
+ */
+template <typename RecordType=std::string>
+class AsyncSink : public BasicModule
+{
+public:
+  explicit AsyncSink(std::size_t buffer_size=1024)
+    : writer_(std::make_shared<Writer>(buffer_size))
+  {}
+
+  ~AsyncSink()
+  {
+    // the writer thread calls the methods of the derived class, which has
+    // already been destroyed here.
+    if (is_master() && writer_->thread.joinable()) {
+      std::cerr << module_id() << ": the writer thread is not stopped by the destructor of the derived class" << std::endl;
+      stop_writer();
+    }
+  }
+
+protected:
+  AsyncSink(const AsyncSink& r)
+    : BasicModule(r),
+      writer_(r.writer_),
+      output_order_(r.output_order_)
+  {}
+
+public:
+  /**
+   * set the order of the records. This should be set before the chains
+   * are duplicated, e.g., in the constructor or in mod_define().
+   */
+  void set_output_order(SinkOrder v)
+  {
+    output_order_ = v;
+    set_order_sensitive(v == SinkOrder::loop_index);
+  }
+  SinkOrder output_order() const { return output_order_; }
+
+  std::size_t output_buffer_size() const { return writer_->buffer.capacity(); }
+
+  /**
+   * number of records for which the chains waited for the writer.
+   */
+  std::size_t number_of_output_stalls() const { return writer_->buffer.number_of_full_waits(); }
+
+  ANLStatus mod_begin_run() override
+  {
+    if (is_master()) {
+      stop_writer();
+      start_writer();
+    }
+    return AS_OK;
+  }
+
+  ANLStatus mod_analyze() override
+  {
+    RecordType record;
+    if (!serialize_event(record)) {
+      return AS_OK;
+    }
+
+    if (!writer_->buffer.push(std::move(record))) {
+      if (writer_->error) {
+        std::rethrow_exception(writer_->error);
+      }
+      BOOST_THROW_EXCEPTION( ANLException(this, (boost::format("Output buffer is stopped at loop index %d") % get_loop_index()).str()) );
+    }
+    return AS_OK;
+  }
+
+  ANLStatus mod_end_run() override
+  {
+    if (is_master() && writer_->thread.joinable()) {
+      finish_writer();
+    }
+    return AS_OK;
+  }
+
+  ANLStatus mod_finalize() override
+  {
+    if (is_master()) {
+      stop_writer();
+    }
+    return AS_OK;
+  }
+
+  /**
+   * write and flush all the records of the events before a checkpoint, so
+   * that they are not lost by a resume from the checkpoint.
+   */
+  ANLStatus mod_save_state(std::ostream&) override
+  {
+    if (is_master() && writer_->thread.joinable()) {
+      finish_writer();
+      start_writer();
+    }
+    return AS_OK;
+  }
+
+protected:
+  /**
+   * make the record of the event of the current loop index.
+   * @return false if the event is not written.
+   */
+  virtual bool serialize_event(RecordType& record) = 0;
+
+  /**
+   * write a record. This is called on the writer thread.
+   */
+  virtual void write_record(RecordType& record) = 0;
+
+  /**
+   * flush the output after all the records of the run are written.
+   */
+  virtual void flush_output() {}
+
+  /**
+   * stop the writer thread of the master without writing the records in
+   * the buffer. This does nothing for a clone, or if the thread is not
+   * running.
+   */
+  void stop_writer()
+  {
+    if (is_master() && writer_->thread.joinable()) {
+      writer_->buffer.abort();
+      writer_->thread.join();
+    }
+  }
+
+private:
+  struct Writer
+  {
+    explicit Writer(std::size_t buffer_size) : buffer(buffer_size) {}
+
+    MPSCRingBuffer<RecordType> buffer;
+    std::thread thread;
+    std::exception_ptr error;
+  };
+
+  void write_records()
+  {
+    RecordType record;
+    try {
+      while (writer_->buffer.pop(record)) {
+        write_record(record);
+      }
+    }
+    catch (...) {
+      // the error is visible to the producers stopped by abort().
+      writer_->error = std::current_exception();
+      writer_->buffer.abort();
+    }
+  }
+
+  void start_writer()
+  {
+    writer_->buffer.reset();
+    writer_->error = nullptr;
+    writer_->thread = std::thread(&AsyncSink::write_records, this);
+  }
+
+  void finish_writer()
+  {
+    writer_->buffer.close();
+    writer_->thread.join();
+    if (writer_->error) {
+      std::rethrow_exception(writer_->error);
+    }
+    flush_output();
+  }
+
+private:
+  std::shared_ptr<Writer> writer_;
+  SinkOrder output_order_ = SinkOrder::arrival;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_AsyncSink_H */
@@ -38,7 +38,12 @@
 #include "ModuleParameter.hh"
 #include "ANLException.hh"
 #include "ModuleAccess.hh"
+#include "ModuleRef.hh"
+#include "SharedState.hh"
 #include "ANLMacro.hh"
+#include "EvsManager.hh"
+#include "EventDataBus.hh"
+#include "EventArena.hh"
 
 #ifdef ANLNEXT_USE_TVECTOR
 #include "TVector2.h"
@@ -53,8 +58,6 @@
 namespace anlnext
 {
 
-class EvsManager;
-
 /**
  * A basic class for an ANL Next module.
  *
@@ -69,6 +72,15 @@ class EvsManager;
  * @date 2019-12-25 | get-result
  * @date 2023-05-10 | singleton module
  * @date 2024-09-02 | add module information in set_parameter() exception
+ * @date 2026-10-18 | EVS methods with a handle
+ * @date 2026-10-18 | get-module methods with ModuleRef
+ * @date 2026-10-18 | shared immutable state
+ * @date 2026-10-18 | associative merge flag
+ * @date 2026-10-18 | partial reduction during the analysis loop
+ * @date 2026-10-18 | state save and restore for checkpoints
+ * @date 2026-10-18 | batched analysis
+ * @date 2026-10-18 | per-event data bus
+ * @date 2026-10-18 | per-event arena
  */
 class BasicModule
 {
@@ -107,6 +119,50 @@ public:
   void set_order_sensitive(bool v) { order_sensitive_ = v; }
   bool is_order_sensitive() const { return order_sensitive_; }
 
+  /**
+   * declare that mod_merge() is associative, i.e., the result does not
+   * depend on how the clones are grouped. Then the multi-thread manager
+   * may merge the clones into each other in parallel (pairwise tree
+   * reduction) and call mod_reduce() of the master module with a single
+   * clone holding the partial result. The contents of the other clones
+   * are not defined after the reduction.
+   */
+  void set_associative_merge(bool v=true) { associative_merge_ = v; }
+  bool is_associative_merge() const { return associative_merge_; }
+
+  /**
+   * enable the partial reduction during the analysis loop (multi-thread
+   * mode with set_partial_reduction_period() or
+   * set_partial_reduction_interval() of the manager).
+   * When requested, each chain calls mod_detach_delta() between two events;
+   * the module moves what it has accumulated since the last call into a
+   * delta buffer, e.g., by swapping histograms. Then the reducer thread
+   * calls mod_merge_delta() of the master module with the module of that
+   * chain (including the master itself) while the analysis continues.
+   * mod_merge_delta() must not touch the data used by mod_analyze() of the
+   * master, and the delta buffer is not touched by the chain until it has
+   * been merged. A critical error returned by these methods stops the loop.
+   * A normal error returned by mod_merge_delta() is reported, and stops the
+   * partial reduction for the rest of the loop.
+   */
+  void set_partial_reduction(bool v=true) { partial_reduction_ = v; }
+  bool is_partial_reduction() const { return partial_reduction_; }
+
+  /**
+   * if true, the module processes a batch of events at once by
+   * mod_analyze_batch() when the manager runs in batch mode
+   * (ANLManager::set_batch_size()). Consecutive batch modules process the
+   * batch one module after another, while the other modules process it one
+   * event after another. A batch module keeps its results for all the
+   * events of the batch, so that the following modules can read those of
+   * the event of their loop index. It does not use the EVS flags in
+   * mod_analyze_batch(), and its mod_analyze() is still used for an event
+   * that is redone. It does not publish event data either, since a slot
+   * holds the value of one event.
+   */
+  void set_batch_analysis(bool v=true) { batch_analysis_ = v; }
+  bool is_batch_analysis() const { return batch_analysis_; }
+
   void set_singleton(int copyID)
   {
     singleton_ = true;
@@ -122,6 +178,14 @@ public:
   int singleton_copy_id() const { return singleton_copy_ID_; }
 
   void automatic_switch_for_singleton();
+
+  /**
+   * the shared state is frozen by the manager after mod_initialize() of the
+   * master module; see publish_shared_state().
+   */
+  void freeze_shared_state() { shared_state_->freeze(); }
+  void unfreeze_shared_state() { shared_state_->unfreeze(); }
+  bool is_shared_state_frozen() const { return shared_state_->is_frozen(); }
   
   virtual ANLStatus mod_define()         { return AS_OK; }
   virtual ANLStatus mod_pre_initialize() { return AS_OK; }
@@ -131,8 +195,28 @@ public:
   virtual ANLStatus mod_end_run()        { return AS_OK; }
   virtual ANLStatus mod_finalize()       { return AS_OK; }
 
+  /**
+   * process the events of loop indices [first_index, first_index+n), where
+   * n is the size of statuses. Only the events with status of AS_OK on
+   * entry are processed, and their statuses are replaced by the results
+   * in the same way as mod_analyze() returns.
+   */
+  virtual void mod_analyze_batch(long int first_index, std::vector<ANLStatus>& statuses);
+
   virtual ANLStatus mod_reduce(const std::list<BasicModule*>& parallel_modules);
   virtual ANLStatus mod_merge(const BasicModule*) { return AS_OK; }
+  virtual ANLStatus mod_detach_delta() { return AS_OK; }
+  virtual ANLStatus mod_merge_delta(BasicModule*) { return AS_OK; }
+
+  /**
+   * save and restore the state accumulated in the analysis loop, such as
+   * histograms, for a checkpoint of the manager. These are called for the
+   * modules of every chain between two events; mod_restore_state() is called
+   * after mod_begin_run(). A module that does not implement them is
+   * restarted from the state after mod_begin_run().
+   */
+  virtual ANLStatus mod_save_state(std::ostream&) { return AS_OK; }
+  virtual ANLStatus mod_restore_state(std::istream&) { return AS_OK; }
 
   virtual ANLStatus mod_communicate() { ask_parameters(); return AS_OK; }
 
@@ -148,6 +232,9 @@ public:
   void set_module_description(const std::string& v) { module_description_ = v; }
 
   void set_evs_manager(EvsManager* man) { evs_manager_ = man; }
+  void set_event_data_bus(EventDataBus* bus) { event_data_bus_ = bus; }
+  void set_event_arena(EventArena* arena) { event_arena_ = arena; }
+  EventArena* event_arena() const { return event_arena_; }
   void set_module_access(const ModuleAccess* aa) { module_access_ = aa; }
 
   ModuleAccess::Permission access_permission() const
@@ -175,6 +262,14 @@ public:
 
   void set_loop_index(long int index) { loop_index_ = index; }
   long int get_loop_index() const { return loop_index_; }
+
+  /**
+   * maximum distance between the loop indices that the chains may be
+   * processing at the same time, set by the manager before mod_begin_run()
+   * of the master. A negative value means no limit.
+   */
+  void set_loop_index_span(long int v) { loop_index_span_ = v; }
+  long int loop_index_span() const { return loop_index_span_; }
   
   /**
    * expose a module parameter specified by "name" and set it as the current parameter.
@@ -349,6 +444,18 @@ protected:
   T* get_module_NC(const std::string& name)
   { return static_cast<T*>(module_access_->get_module_NC(name)); }
 
+  /*
+   * resolve a module reference, which is then used in mod_analyze() with no
+   * lookup. Call these in mod_initialize().
+   */
+  template <typename T>
+  void get_module(const std::string& name, ModuleRef<const T>& ref)
+  { ref.ptr_ = static_cast<const T*>(module_access_->get_module(name)); }
+
+  template <typename T>
+  void get_module_NC(const std::string& name, ModuleRef<T>& ref)
+  { ref.ptr_ = static_cast<T*>(module_access_->get_module_NC(name)); }
+
   template <typename T>
   void get_module_IF(const std::string& name, const T** ptr);
 
@@ -380,6 +487,29 @@ protected:
   template <typename T>
   void request_module_IFNC(const std::string& name, T** ptr);
 
+  /*
+   * shared immutable state
+   *
+   * The master module can publish immutable objects, such as large tables,
+   * up to its mod_initialize(). The clones obtain them by get_shared_state()
+   * in their mod_initialize() instead of having their own copies. The state
+   * is frozen when mod_initialize() of the master chain is done, and it can
+   * be read concurrently after that.
+   */
+  template <typename T>
+  std::shared_ptr<const T> publish_shared_state(const std::string& name, std::shared_ptr<const T> object);
+
+  template <typename T, typename... Args>
+  std::shared_ptr<const T> make_shared_state(const std::string& name, Args&&... args)
+  { return publish_shared_state<T>(name, std::make_shared<const T>(std::forward<Args>(args)...)); }
+
+  template <typename T>
+  std::shared_ptr<const T> get_shared_state(const std::string& name) const
+  { return shared_state_->get<T>(name); }
+
+  bool has_shared_state(const std::string& name) const
+  { return shared_state_->contains(name); }
+
   /*
    * access to singleton
    */
@@ -390,13 +520,67 @@ protected:
    * EVS methods
    */
 
-  void define_evs(const std::string& key);
+  EvsHandle define_evs(const std::string& key);
   void undefine_evs(const std::string& key);
   bool is_evs_defined(const std::string& key) const;
   bool evs(const std::string& key) const;
   void set_evs(const std::string& key);
   void reset_evs(const std::string& key);
 
+  /*
+   * EVS methods with a handle, which is returned by define_evs() or
+   * evs_handle(). These are faster than those with a string key.
+   */
+  EvsHandle evs_handle(const std::string& key) const;
+  bool evs(EvsHandle handle) const { return evs_manager_->get(handle); }
+  void set_evs(EvsHandle handle) { evs_manager_->set(handle); }
+  void reset_evs(EvsHandle handle) { evs_manager_->reset(handle); }
+
+  /*
+   * per-event data
+   *
+   * A producer defines a slot in mod_define() and publishes the value for
+   * each event; a consumer gets the handle of the slot, e.g., in
+   * mod_initialize(), and reads the value of the current event. The value
+   * returned by publish_event_data() is that left by the previous event, so
+   * that the producer overwrites it, reusing its capacity.
+   * event_data() returns nullptr if the value is not published for the
+   * current loop index.
+   */
+  template <typename T>
+  EventDataHandle<T> define_event_data(const std::string& key)
+  { return event_data_bus_->define<T>(key); }
+
+  template <typename T>
+  EventDataHandle<T> event_data_handle(const std::string& key) const
+  { return event_data_bus_->handle<T>(key); }
+
+  bool is_event_data_defined(const std::string& key) const
+  { return event_data_bus_->is_defined(key); }
+
+  template <typename T>
+  T& publish_event_data(EventDataHandle<T> handle)
+  { return event_data_bus_->publish(handle, loop_index_); }
+
+  template <typename T>
+  const T* event_data(EventDataHandle<T> handle) const
+  { return event_data_bus_->get(handle, loop_index_); }
+
+  /*
+   * per-event memory
+   *
+   * The arena of the chain is rewound by the manager at the start of each
+   * event (of each batch in batch mode), e.g.,
+   * std::pmr::vector<Hit> hits(event_allocator<Hit>());
+   * Objects allocated from it must not be kept over events.
+   */
+  std::pmr::memory_resource* event_memory_resource() const
+  { return event_arena_; }
+
+  template <typename T>
+  std::pmr::polymorphic_allocator<T> event_allocator() const
+  { return std::pmr::polymorphic_allocator<T>(event_arena_); }
+
 protected:
   template <typename ModuleType>
   std::unique_ptr<BasicModule> make_clone(ModuleType*&& copied);
@@ -408,17 +592,23 @@ private:
 
 private:
   bool order_sensitive_ = false;
+  bool associative_merge_ = false;
+  bool partial_reduction_ = false;
+  bool batch_analysis_ = false;
   std::string module_ID_;
   std::vector<std::pair<std::string, ModuleAccess::ConflictOption>> aliases_;
   ModuleAccess::Permission access_permission_ = ModuleAccess::Permission::full_access;
   std::string module_description_;
   bool module_on_ = true;
   EvsManager* evs_manager_ = nullptr;
+  EventDataBus* event_data_bus_ = nullptr;
+  EventArena* event_arena_ = nullptr;
   const ModuleAccess* module_access_ = nullptr;
   ModuleParamList module_parameters_;
   ModuleParam_sptr current_parameter_;
   ModuleParam_sptr current_value_element_;
   long int loop_index_ = -1;
+  long int loop_index_span_ = 1;
 
   const int copy_ID_ = 0;
   int last_copy_ = 0;
@@ -426,6 +616,7 @@ private:
   bool singleton_ = false;
   int singleton_copy_ID_ = 0;
   std::shared_ptr<BasicModule*> singleton_ptr_;
+  std::shared_ptr<SharedState> shared_state_;
 
   std::string (BasicModule::*module_ID_method_)() const;
 };
@@ -433,6 +624,16 @@ private:
 using AMIter = std::vector<BasicModule*>::iterator;
 using AMConstIter = std::vector<BasicModule*>::const_iterator;
 
+template <typename T>
+std::shared_ptr<const T> BasicModule::publish_shared_state(const std::string& name, std::shared_ptr<const T> object)
+{
+  if (!is_master()) {
+    BOOST_THROW_EXCEPTION( ANLException(this, (boost::format("Shared state can be published only by the master module ===> %s") % name).str()) );
+  }
+  shared_state_->publish<T>(name, object);
+  return object;
+}
+
 template <typename ModuleClass, typename T>
 void BasicModule::define_parameter(const std::string& name, T ModuleClass::* ptr)
 {
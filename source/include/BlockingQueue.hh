@@ -0,0 +1,114 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_BlockingQueue_H
+#define ANLNEXT_BlockingQueue_H 1
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace anlnext
+{
+
+/**
+ * Unbounded FIFO queue shared by multiple producers and consumers.
+ * pop() blocks while the queue is empty and open.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class BlockingQueue
+{
+public:
+  BlockingQueue() = default;
+  ~BlockingQueue() = default;
+  BlockingQueue(const BlockingQueue&) = delete;
+  BlockingQueue(BlockingQueue&&) = delete;
+  BlockingQueue& operator=(const BlockingQueue&) = delete;
+  BlockingQueue& operator=(BlockingQueue&&) = delete;
+
+  /**
+   * make the queue empty and open.
+   */
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+    closed_ = false;
+    aborted_ = false;
+  }
+
+  void push(const T& value)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(value);
+    }
+    cv_.notify_one();
+  }
+
+  /**
+   * @return false if the queue is closed and empty, or aborted.
+   */
+  bool pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this](){ return (aborted_ || closed_ || !queue_.empty()); });
+    if (aborted_ || queue_.empty()) {
+      return false;
+    }
+    value = queue_.front();
+    queue_.pop_front();
+    return true;
+  }
+
+  /**
+   * notify the consumers that no more element comes.
+   */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  void abort()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      aborted_ = true;
+    }
+    cv_.notify_all();
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<T> queue_;
+  bool closed_ = false;
+  bool aborted_ = false;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_BlockingQueue_H */
@@ -0,0 +1,85 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_CacheAligned_H
+#define ANLNEXT_CacheAligned_H 1
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * size of a cache line assumed for the per-chain state.
+ * Data written by different threads are placed on different lines of this
+ * size to avoid false sharing.
+ */
+constexpr std::size_t CacheLineSize = 64;
+
+/**
+ * Allocator that places each allocation at the beginning of a cache line
+ * and rounds its size up to whole cache lines, so that no other object
+ * shares a line with the allocated array.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class CacheAlignedAllocator
+{
+public:
+  using value_type = T;
+
+  CacheAlignedAllocator() noexcept = default;
+  template <typename U>
+  CacheAlignedAllocator(const CacheAlignedAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(::operator new(padded_size(n), std::align_val_t(CacheLineSize)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    ::operator delete(p, padded_size(n), std::align_val_t(CacheLineSize));
+  }
+
+private:
+  static std::size_t padded_size(std::size_t n)
+  {
+    return (n*sizeof(T) + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const CacheAlignedAllocator<T>&, const CacheAlignedAllocator<U>&) noexcept
+{ return true; }
+
+template <typename T, typename U>
+bool operator!=(const CacheAlignedAllocator<T>&, const CacheAlignedAllocator<U>&) noexcept
+{ return false; }
+
+template <typename T>
+using CacheAlignedVector = std::vector<T, CacheAlignedAllocator<T>>;
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_CacheAligned_H */
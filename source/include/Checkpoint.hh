@@ -0,0 +1,127 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_Checkpoint_H
+#define ANLNEXT_Checkpoint_H 1
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace anlnext
+{
+
+class BasicModule;
+class LoopCounter;
+class EvsManager;
+
+/**
+ * Writer of a checkpoint file of an analysis loop.
+ * The data are written to a temporary file, which replaces the checkpoint
+ * file at commit(), so that the last checkpoint survives a crash during
+ * writing.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class CheckpointWriter
+{
+public:
+  explicit CheckpointWriter(const std::string& filename);
+  ~CheckpointWriter();
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter(CheckpointWriter&&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(CheckpointWriter&&) = delete;
+
+  template <typename T>
+  void write(const T& v)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "CheckpointWriter::write() needs a trivially copyable type");
+    stream_.write(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+
+  void write_string(const std::string& s);
+
+  /**
+   * write the counters, the EVS counts, and the states of the modules of a
+   * chain.
+   */
+  void write_chain(const std::vector<BasicModule*>& modules,
+                   const std::vector<LoopCounter>& counters,
+                   const EvsManager& evs_manager);
+
+  void commit();
+
+private:
+  std::string filename_;
+  std::string temporary_filename_;
+  std::ofstream stream_;
+  bool committed_ = false;
+};
+
+/**
+ * Reader of a checkpoint file of an analysis loop.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class CheckpointReader
+{
+public:
+  explicit CheckpointReader(const std::string& filename);
+  ~CheckpointReader();
+  CheckpointReader(const CheckpointReader&) = delete;
+  CheckpointReader(CheckpointReader&&) = delete;
+  CheckpointReader& operator=(const CheckpointReader&) = delete;
+  CheckpointReader& operator=(CheckpointReader&&) = delete;
+
+  template <typename T>
+  T read()
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "CheckpointReader::read() needs a trivially copyable type");
+    T v;
+    stream_.read(reinterpret_cast<char*>(&v), sizeof(T));
+    check_stream();
+    return v;
+  }
+
+  std::string read_string();
+
+  /**
+   * restore the counters, the EVS counts, and the states of the modules of
+   * a chain. The modules must be the same as those written.
+   */
+  void read_chain(const std::vector<BasicModule*>& modules,
+                  std::vector<LoopCounter>& counters,
+                  EvsManager& evs_manager);
+
+private:
+  void check_stream();
+
+private:
+  std::string filename_;
+  std::ifstream stream_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_Checkpoint_H */
@@ -26,6 +26,8 @@ namespace anlnext
 {
 
 class EvsManager;
+class EventDataBus;
+class EventArena;
 class ModuleAccess;
 class BasicModule;
 
@@ -34,11 +36,14 @@ class BasicModule;
  *
  * @author Hirokazu Odaka
  * @date 2017-07-05
+ * @date 2026-10-18 | a chain can be a segment of the master chain
+ * @date 2026-10-18 | per-event data bus
+ * @date 2026-10-18 | per-event arena
  */
 class ClonedChainSet
 {
 public:
-  ClonedChainSet(int chain_id, const EvsManager& evs);
+  ClonedChainSet(int chain_id, const EvsManager& evs, const EventDataBus& event_data);
   ~ClonedChainSet();
   ClonedChainSet(ClonedChainSet&&) = default;
   ClonedChainSet& operator=(ClonedChainSet&&) = default;
@@ -49,8 +54,23 @@ public:
   int chain_id() const { return id_; }
   
   void push(std::unique_ptr<BasicModule>&& mod);
+
+  /**
+   * register a module of the master chain that is not cloned, so that the
+   * cloned modules can access it. The module is not processed by this chain.
+   */
+  void push_shared(BasicModule* mod);
   void setup_module_access();
+
+  /**
+   * index of the first cloned module in the master chain.
+   * The i-th module of this chain corresponds to the (offset+i)-th module
+   * of the master chain.
+   */
+  void set_module_offset(std::size_t v) { module_offset_ = v; }
+  std::size_t module_offset() const { return module_offset_; }
   void reset_counters();
+  void set_counter_timing(bool v);
 
   const std::vector<BasicModule*>& modules_reference() const
   { return modules_ref_; }
@@ -64,16 +84,37 @@ public:
   const EvsManager& get_evs() const
   { return *evs_manager_; }
 
+  /**
+   * define the EVS keys that are defined in the given manager but not in
+   * the chain, e.g., keys defined by shared modules.
+   */
+  void define_missing_evs(const EvsManager& evs);
+
+  EventDataBus& event_data_bus()
+  { return *event_data_bus_; }
+
+  EventArena& event_arena()
+  { return *event_arena_; }
+  const EventArena& event_arena() const
+  { return *event_arena_; }
+
   BasicModule* access_to_module(const std::string& module_ID);
 
   void automatic_switch_for_singletons();
+
+private:
+  void register_to_module_access(BasicModule* mod);
   
 private:
   int id_;
+  std::size_t module_offset_ = 0;
   std::unique_ptr<EvsManager> evs_manager_;
+  std::unique_ptr<EventDataBus> event_data_bus_;
+  std::unique_ptr<EventArena> event_arena_;
   std::unique_ptr<ModuleAccess> module_access_;
   std::vector<std::unique_ptr<BasicModule>> modules_;
   std::vector<BasicModule*> modules_ref_;
+  std::vector<BasicModule*> shared_modules_;
   std::vector<LoopCounter> counters_;
 };
 
@@ -0,0 +1,132 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_EventArena_H
+#define ANLNEXT_EventArena_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * Monotonic memory resource for per-event allocations of a chain.
+ *
+ * Memory is taken from the current block by moving a pointer, and
+ * deallocation does nothing. The manager rewinds the arena at the start of
+ * each event, so that all the memory allocated in an event is released at
+ * once; objects allocated from it must not outlive the event. When an
+ * event needs more than one block, the blocks are replaced by a single
+ * block of their total size at the next rewind, and the arena settles to
+ * one block large enough for the events.
+ *
+ * A module obtains a std::pmr::polymorphic_allocator bound to the arena by
+ * BasicModule::event_allocator(), e.g., for std::pmr::vector.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class EventArena : public std::pmr::memory_resource
+{
+public:
+  static constexpr std::size_t DefaultBlockSize = 64*1024;
+
+  explicit EventArena(std::size_t block_size=DefaultBlockSize);
+  ~EventArena();
+  EventArena(const EventArena&) = delete;
+  EventArena(EventArena&&) = delete;
+  EventArena& operator=(const EventArena&) = delete;
+  EventArena& operator=(EventArena&&) = delete;
+
+  /**
+   * release all the memory allocated since the last rewind.
+   * Rewinding twice in an event does nothing more.
+   */
+  void rewind()
+  {
+    if (used_ > peak_usage_) { peak_usage_ = used_; }
+    used_ = 0;
+    if (block_index_ > 0) {
+      consolidate();
+    }
+    current_ = blocks_[0].begin;
+    end_ = blocks_[0].end;
+  }
+
+  /**
+   * bytes taken in the current event, including padding for alignment and
+   * the unused ends of the blocks.
+   */
+  std::size_t usage() const { return used_; }
+
+  /**
+   * largest bytes allocated in an event since the last reset.
+   */
+  std::size_t peak_usage() const
+  { return (used_ > peak_usage_) ? used_ : peak_usage_; }
+  void reset_peak_usage() { peak_usage_ = 0; }
+
+  std::size_t capacity() const;
+  std::size_t number_of_blocks() const { return blocks_.size(); }
+
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    const std::uintptr_t current = reinterpret_cast<std::uintptr_t>(current_);
+    const std::uintptr_t p = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    if (p + bytes <= reinterpret_cast<std::uintptr_t>(end_)) {
+      used_ += (p + bytes) - current;
+      current_ = reinterpret_cast<unsigned char*>(p + bytes);
+      return reinterpret_cast<void*>(p);
+    }
+    return allocate_from_next_block(bytes, alignment);
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource& r) const noexcept override
+  { return this == &r; }
+
+private:
+  struct Block
+  {
+    unsigned char* begin;
+    unsigned char* end;
+  };
+
+  void* allocate_from_next_block(std::size_t bytes, std::size_t alignment);
+  void consolidate();
+  static Block allocate_block(std::size_t size);
+  static void free_block(const Block& block);
+
+private:
+  std::vector<Block> blocks_;
+  std::size_t block_index_ = 0;
+  unsigned char* current_ = nullptr;
+  unsigned char* end_ = nullptr;
+  std::size_t used_ = 0;
+  std::size_t peak_usage_ = 0;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_EventArena_H */
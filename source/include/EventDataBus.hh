@@ -0,0 +1,198 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_EventDataBus_H
+#define ANLNEXT_EventDataBus_H 1
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "CacheAligned.hh"
+
+namespace anlnext
+{
+
+/**
+ * Handle of a slot of the event data bus, typed by the value of the slot.
+ * The slots have the same handles in all the chains, since the bus of a
+ * cloned chain is a copy of that of the master chain.
+ */
+template <typename T>
+struct EventDataHandle
+{
+  int index = -1;
+  bool is_valid() const { return index >= 0; }
+};
+
+/**
+ * Typed per-event data passed among the modules of a chain.
+ *
+ * A producer module defines a slot by a key and a type in mod_define() (or
+ * mod_pre_initialize()), and writes the value of each event into it by
+ * publish(); a consumer module resolves the key to a handle, and reads the
+ * value by get(). Each chain owns a bus, so the modules do not need to
+ * access each other by get_module().
+ *
+ * The values of all the slots are constructed once in a single chain-local
+ * arena when the layout is fixed by allocate(), and are kept over the
+ * events; publish() returns the value left by the previous event so that
+ * its capacity (e.g., of a vector) is reused. A value is valid for the
+ * event whose loop index is given to publish() as the stamp; thus the bus
+ * needs no reset per event.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class EventDataBus
+{
+public:
+  EventDataBus() = default;
+  ~EventDataBus();
+
+  /**
+   * copy the layout of the slots. If r has been allocated, the copy has
+   * its own arena with default-constructed values.
+   */
+  EventDataBus(const EventDataBus& r);
+  EventDataBus(EventDataBus&&) = delete;
+  EventDataBus& operator=(const EventDataBus&) = delete;
+  EventDataBus& operator=(EventDataBus&&) = delete;
+
+  /**
+   * define a slot. Defining a defined key with the same type returns the
+   * same handle.
+   */
+  template <typename T>
+  EventDataHandle<T> define(const std::string& key)
+  {
+    static_assert(alignof(T) <= CacheLineSize, "EventDataBus: over-aligned type");
+    EventDataHandle<T> h;
+    h.index = define_slot(key, std::type_index(typeid(T)), sizeof(T), alignof(T),
+                          [](void* p) { new (p) T(); },
+                          [](void* p) { static_cast<T*>(p)->~T(); });
+    return h;
+  }
+
+  /**
+   * get the handle of a defined slot; the type has to be the same as the
+   * definition.
+   */
+  template <typename T>
+  EventDataHandle<T> handle(const std::string& key) const
+  {
+    EventDataHandle<T> h;
+    h.index = find_slot(key, std::type_index(typeid(T)));
+    return h;
+  }
+
+  bool is_defined(const std::string& key) const
+  { return handles_.count(key) > 0; }
+
+  std::size_t number_of_slots() const { return slots_.size(); }
+
+  /**
+   * fix the layout and construct the values. No slot can be defined after
+   * this. Allocating an allocated bus does nothing.
+   */
+  void allocate();
+  bool is_allocated() const { return allocated_; }
+
+  /**
+   * size of the arena in bytes.
+   */
+  std::size_t arena_size() const { return arena_.size(); }
+
+  /**
+   * get the value of the slot to be written for the event of the stamp.
+   * The bus has to be allocated.
+   */
+  template <typename T>
+  T& publish(EventDataHandle<T> h, long int stamp)
+  {
+    stamps_[h.index] = stamp;
+    return *static_cast<T*>(value_address(h.index));
+  }
+
+  /**
+   * get the value of the slot published for the event of the stamp.
+   * @return pointer to the value, or nullptr if it is not published.
+   */
+  template <typename T>
+  const T* get(EventDataHandle<T> h, long int stamp) const
+  {
+    if (stamps_[h.index] != stamp) {
+      return nullptr;
+    }
+    return static_cast<const T*>(value_address(h.index));
+  }
+
+  bool is_published(int index, long int stamp) const
+  { return stamps_[index] == stamp; }
+
+  /**
+   * make all the values unpublished, e.g., at the start of an analysis
+   * loop that may reuse the loop indices.
+   */
+  void invalidate();
+
+private:
+  using Construct = void (*)(void*);
+  using Destroy = void (*)(void*);
+
+  struct Slot
+  {
+    std::string key;
+    std::type_index type;
+    std::size_t size;
+    std::size_t alignment;
+    std::size_t offset;
+    Construct construct;
+    Destroy destroy;
+  };
+
+  static constexpr long int unpublished = std::numeric_limits<long int>::min();
+
+  int define_slot(const std::string& key,
+                  std::type_index type,
+                  std::size_t size,
+                  std::size_t alignment,
+                  Construct construct,
+                  Destroy destroy);
+  int find_slot(const std::string& key, std::type_index type) const;
+  void* value_address(int index)
+  { return arena_.data() + slots_[index].offset; }
+  const void* value_address(int index) const
+  { return arena_.data() + slots_[index].offset; }
+
+private:
+  std::vector<Slot> slots_;
+  std::unordered_map<std::string, int> handles_;
+  bool allocated_ = false;
+  // the arena is cache-line aligned since each chain owns a bus.
+  CacheAlignedVector<unsigned char> arena_;
+  CacheAlignedVector<long int> stamps_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_EventDataBus_H */
@@ -23,7 +23,11 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
+#include <boost/property_tree/ptree.hpp>
+#include "CacheAligned.hh"
 
 namespace anlnext
 {
@@ -54,18 +58,55 @@ using EvsMap = std::map<std::string, EvsData>;
 using EvsIter = EvsMap::iterator;
 using EvsConstIter = EvsMap::const_iterator;
 
+/**
+ * Handle of an Evs flag.
+ * A key is interned into the same handle in all the EvsManager objects, so
+ * that a handle obtained by a module is also valid for its clones.
+ */
+using EvsHandle = int;
+
 /**
  * The Evs (event selection) management class.
  * This class provides a flag that can be accessed from any ANL module for event selection.
  *
+ * The flags are stored in a bitset indexed by handles, and the counts in
+ * arrays of the same index. The methods taking a handle are O(1), while the
+ * methods taking a string key need a hash lookup.
+ *
+ * The words of the bitset that have been set since the last reset are
+ * tracked, and the per-event reset and counting visit only these words.
+ * The counting adds each word into bit-sliced counters (one word per bit of
+ * the counts), which are flushed into the count arrays before they are read.
+ * Thus the per-event cost does not depend on the number of defined flags.
+ *
  * @author Hirokazu Odaka
  * @date 2010-06-xx
  * @date 2014-12-18
  * @date 2016-12-20 | add count_ok
  * @date 2017-07-07 | add merge(), rename methods
+ * @date 2026-10-18 | add save_flags(), restore_flags()
+ * @date 2026-10-18 | flag handles, bitset storage
+ * @date 2026-10-18 | dirty-word tracking, bit-sliced counters
+ * @date 2026-10-18 | add summary_to_property_tree()
+ * @date 2026-10-18 | cache-line-aligned storage
+ * @date 2026-10-18 | add restore_counts()
  */
 class EvsManager
 {
+public:
+  static const EvsHandle invalid_handle = -1;
+
+  /**
+   * get the handle of the key, registering it if it is new.
+   * This does not define the flag in any EvsManager.
+   */
+  static EvsHandle intern(const std::string& key);
+
+  /**
+   * get the key of the handle.
+   */
+  static std::string key_of(EvsHandle handle);
+
 public:
   EvsManager() = default;
   ~EvsManager();
@@ -78,75 +119,241 @@ public:
 
   /**
    * define an Evs flag.
+   * @return handle of the flag.
    */
-  void define(const std::string& key)
-  { data_[key] = EvsData(); }
+  EvsHandle define(const std::string& key);
+
+  /**
+   * define the flags that are defined in r but not in this.
+   */
+  void define_missing(const EvsManager& r);
 
   /**
    * unregister an Evs flag.
    */
-  void undefine(const std::string& key) { data_.erase(key); }
+  void undefine(const std::string& key);
 
   bool is_defined(const std::string& key) const
-  { return data_.count(key); }
+  { return handles_.count(key); }
+
+  bool is_defined(EvsHandle handle) const
+  {
+    return (handle >= 0
+            && static_cast<std::size_t>(handle) < capacity()
+            && (defined_[word_index(handle)] & bit_mask(handle)));
+  }
+
+  /**
+   * get the handle of a defined flag.
+   * @return handle, or invalid_handle if the key is not defined.
+   */
+  EvsHandle handle(const std::string& key) const;
+
+  std::size_t number_of_flags() const { return handles_.size(); }
 
   /**
    * get an Evs flag value.
    */
   bool get(const std::string& key) const;
+  bool get(EvsHandle handle) const;
 
   /**
    * set an Evs flag as true.
    */
   void set(const std::string& key);
+  void set(EvsHandle handle);
 
   /**
    * set an Evs flag as false.
    */
   void reset(const std::string& key);
+  void reset(EvsHandle handle);
   
   void reset_all_flags();
   void reset_all_counts();
 
+  /**
+   * copy all the flags as bitset words.
+   * This is used to pass the flags to another EvsManager.
+   */
+  void save_flags(std::vector<uint64_t>& flags) const
+  { flags.assign(flags_.begin(), flags_.end()); }
+  void restore_flags(const std::vector<uint64_t>& flags);
+
   void count();
   void count_completed();
   void print_summary() const;
 
-  const EvsMap& data() const { return data_; }
+  /**
+   * get the counts of the flags, sorted by key, as a property tree.
+   */
+  boost::property_tree::ptree summary_to_property_tree() const;
+
+  uint64_t counts(EvsHandle handle) const
+  { return counts_[handle] + counter_.pending(handle); }
+  uint64_t counts_completed(EvsHandle handle) const
+  { return counts_ok_[handle] + counter_ok_.pending(handle); }
+
+  /**
+   * get the flags and counts as a map.
+   * This builds a new map, and is not for use in the event loop.
+   */
+  EvsMap data() const;
+
+  /**
+   * replace the counts by those of the map, e.g., taken by data() for a
+   * checkpoint. Keys that are not defined are defined; the flags are not
+   * changed.
+   */
+  void restore_counts(const EvsMap& data);
   void merge(const EvsManager& r);
 
 private:
-  EvsMap data_;
+  /**
+   * counters for the bits of the flag words, stored as bit planes.
+   * Plane k of a word holds the k-th bits of the 64 counters.
+   */
+  class SlicedCounter
+  {
+  public:
+    static const int NumPlanes = 16;
+
+    void resize(std::size_t num_words);
+    void clear();
+
+    void add(std::size_t word, uint64_t bits, CacheAlignedVector<uint64_t>& counts)
+    {
+      uint64_t* planes = &planes_[word*NumPlanes];
+      uint64_t carry = bits;
+      for (int k=0; carry && k<NumPlanes; k++) {
+        const uint64_t c = planes[k] & carry;
+        planes[k] ^= carry;
+        carry = c;
+      }
+      if (++num_added_[word] == MaxAdded) {
+        flush_word(word, counts);
+      }
+    }
+
+    void flush(CacheAlignedVector<uint64_t>& counts);
+
+    /**
+     * count held in the planes, not yet flushed.
+     */
+    uint64_t pending(EvsHandle handle) const
+    {
+      const uint64_t* planes = &planes_[word_index(handle)*NumPlanes];
+      const std::size_t b = static_cast<std::size_t>(handle) & 63;
+      uint64_t v = 0;
+      for (int k=0; k<NumPlanes; k++) {
+        v |= ((planes[k] >> b) & 1) << k;
+      }
+      return v;
+    }
+
+  private:
+    static const uint32_t MaxAdded = (uint32_t(1) << NumPlanes) - 1;
+    void flush_word(std::size_t word, CacheAlignedVector<uint64_t>& counts);
+
+    CacheAlignedVector<uint64_t> planes_;
+    CacheAlignedVector<uint32_t> num_added_;
+  };
+
+private:
+  static std::size_t word_index(EvsHandle handle)
+  { return static_cast<std::size_t>(handle) >> 6; }
+  static uint64_t bit_mask(EvsHandle handle)
+  { return uint64_t(1) << (static_cast<std::size_t>(handle) & 63); }
+
+  std::size_t capacity() const { return counts_.size(); }
+  void expand(EvsHandle handle);
+  void define_handle(const std::string& key, EvsHandle handle);
+  void report_undefined(EvsHandle handle) const;
+  void set_bit(EvsHandle handle)
+  {
+    const std::size_t w = word_index(handle);
+    flags_[w] |= bit_mask(handle);
+    dirty_[w >> 6] |= (uint64_t(1) << (w & 63));
+  }
+  void flush_counts();
+  void add_to_counter(SlicedCounter& counter, CacheAlignedVector<uint64_t>& counts);
+
+private:
+  // the storage is cache-line aligned since each chain owns an EvsManager.
+  CacheAlignedVector<uint64_t> flags_;
+  CacheAlignedVector<uint64_t> dirty_;
+  CacheAlignedVector<uint64_t> defined_;
+  CacheAlignedVector<uint64_t> counts_;
+  CacheAlignedVector<uint64_t> counts_ok_;
+  SlicedCounter counter_;
+  SlicedCounter counter_ok_;
+  std::unordered_map<std::string, EvsHandle> handles_;
 };
 
+inline EvsHandle EvsManager::handle(const std::string& key) const
+{
+  const auto it = handles_.find(key);
+  if (it==handles_.end()) {
+    return invalid_handle;
+  }
+  return it->second;
+}
+
+inline bool EvsManager::get(EvsHandle handle) const
+{
+  if (!is_defined(handle)) {
+    report_undefined(handle);
+    return false;
+  }
+  return (flags_[word_index(handle)] & bit_mask(handle));
+}
+
+inline void EvsManager::set(EvsHandle handle)
+{
+  if (!is_defined(handle)) {
+    report_undefined(handle);
+    return;
+  }
+  set_bit(handle);
+}
+
+inline void EvsManager::reset(EvsHandle handle)
+{
+  if (!is_defined(handle)) {
+    report_undefined(handle);
+    return;
+  }
+  flags_[word_index(handle)] &= ~bit_mask(handle);
+}
+
 inline bool EvsManager::get(const std::string& key) const
 {
-  EvsConstIter it = data_.find(key);
-  if (it==data_.end()) {
+  const EvsHandle h = handle(key);
+  if (h==invalid_handle) {
     std::cout << "EvsManager: Undefined key is given: " << key << std::endl;
     return false;
   }
-  return it->second.flag;
+  return (flags_[word_index(h)] & bit_mask(h));
 }
 
 inline void EvsManager::set(const std::string& key)
 {
-  EvsIter it = data_.find(key);
-  if (it==data_.end()) {
+  const EvsHandle h = handle(key);
+  if (h==invalid_handle) {
     std::cout << "EvsManager: Undefined key is given: " << key << std::endl;
     return;
   }
-  it->second.flag = true;
+  set_bit(h);
 }
 
 inline void EvsManager::reset(const std::string& key)
 {
-  EvsIter it = data_.find(key);
-  if (it==data_.end()) {
+  const EvsHandle h = handle(key);
+  if (h==invalid_handle) {
     std::cout << "EvsManager: Undefined key is given: " << key << std::endl;
     return; 
   }
-  it->second.flag = false;
+  flags_[word_index(h)] &= ~bit_mask(h);
 }
 
 } /* namespace anlnext */
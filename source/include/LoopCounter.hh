@@ -20,7 +20,13 @@
 #ifndef ANLNEXT_LoopCounter_H
 #define ANLNEXT_LoopCounter_H 1
 
+#include <cstdint>
+#include <array>
+#include <istream>
+#include <limits>
+#include <ostream>
 #include "ANLStatus.hh"
+#include "CacheAligned.hh"
 
 namespace anlnext
 {
@@ -30,9 +36,20 @@ namespace anlnext
  *
  * @author Hirokazu Odaka
  * @date 2017-07-02 | based on struct ANLModuleCounter
+ * @date 2026-10-18 | processing time of the module
+ * @date 2026-10-18 | aligned to a cache line
+ * @date 2026-10-18 | binary save and load for checkpoints
+ *
+ * Counters are aligned to cache lines, so that the counter arrays of
+ * different chains never share a line.
  */
-class LoopCounter
+class alignas(CacheLineSize) LoopCounter
 {
+public:
+  /** number of bins of the histogram of processing time in log2(ns) */
+  static const int NumTimeBins = 40;
+  using TimeHistogram = std::array<long int, NumTimeBins>;
+
 public:
   LoopCounter() = default;
   ~LoopCounter() = default;
@@ -46,6 +63,25 @@ public:
   long int error() const { return error_; }
   long int skip() const { return skip_; }
   long int quit() const { return quit_; }
+
+  /**
+   * if true, processing time of the module is measured.
+   * This setting is kept by reset().
+   */
+  void set_timing_enabled(bool v) { timing_enabled_ = v; }
+  bool is_timing_enabled() const { return timing_enabled_; }
+
+  long int timed() const { return timed_; }
+  int64_t total_time() const { return total_time_; }
+  int64_t min_time() const { return (timed_ > 0) ? min_time_ : 0; }
+  int64_t max_time() const { return max_time_; }
+  double mean_time() const
+  { return (timed_ > 0) ? static_cast<double>(total_time_)/timed_ : 0.0; }
+
+  /**
+   * bin i counts the calls that took [2^i, 2^(i+1)) ns; bin 0 includes 0 ns.
+   */
+  const TimeHistogram& time_histogram() const { return time_histogram_; }
   
   void reset()
   {
@@ -54,6 +90,11 @@ public:
     error_ = 0;
     skip_ = 0;
     quit_ = 0;
+    timed_ = 0;
+    total_time_ = 0;
+    min_time_ = std::numeric_limits<int64_t>::max();
+    max_time_ = 0;
+    time_histogram_.fill(0);
   }
 
   void count_up_by_entry()
@@ -79,6 +120,22 @@ public:
     }
   }
 
+  /**
+   * add a processing time in ns.
+   */
+  void count_up_time(int64_t t)
+  {
+    ++timed_;
+    total_time_ += t;
+    if (t < min_time_) { min_time_ = t; }
+    if (t > max_time_) { max_time_ = t; }
+    int bin = 0;
+    for (uint64_t v = (t > 1) ? (static_cast<uint64_t>(t) >> 1) : 0; v != 0 && bin < NumTimeBins-1; v >>= 1) {
+      ++bin;
+    }
+    ++time_histogram_[bin];
+  }
+
   LoopCounter operator+(const LoopCounter& r) const
   {
     LoopCounter a(*this);
@@ -87,6 +144,13 @@ public:
     a.error_ += r.error_;
     a.skip_  += r.skip_;
     a.quit_  += r.quit_;
+    a.timed_ += r.timed_;
+    a.total_time_ += r.total_time_;
+    if (r.min_time_ < a.min_time_) { a.min_time_ = r.min_time_; }
+    if (r.max_time_ > a.max_time_) { a.max_time_ = r.max_time_; }
+    for (int i=0; i<NumTimeBins; i++) {
+      a.time_histogram_[i] += r.time_histogram_[i];
+    }
     return a;
   }
 
@@ -96,12 +160,44 @@ public:
     return *this;
   }
 
+  /**
+   * write the counts in binary, e.g., to a checkpoint. The timing flag is
+   * not written, and is kept by load().
+   */
+  void save(std::ostream& os) const
+  {
+    for (long int v: {entry_, ok_, error_, skip_, quit_, timed_}) {
+      os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    for (int64_t v: {total_time_, min_time_, max_time_}) {
+      os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    os.write(reinterpret_cast<const char*>(time_histogram_.data()), sizeof(time_histogram_));
+  }
+
+  void load(std::istream& is)
+  {
+    for (long int* v: {&entry_, &ok_, &error_, &skip_, &quit_, &timed_}) {
+      is.read(reinterpret_cast<char*>(v), sizeof(*v));
+    }
+    for (int64_t* v: {&total_time_, &min_time_, &max_time_}) {
+      is.read(reinterpret_cast<char*>(v), sizeof(*v));
+    }
+    is.read(reinterpret_cast<char*>(time_histogram_.data()), sizeof(time_histogram_));
+  }
+
 private:
   long int entry_ = 0;
   long int ok_ = 0;
   long int error_ = 0;
   long int skip_ = 0;
   long int quit_ = 0;
+  bool timing_enabled_ = false;
+  long int timed_ = 0;
+  int64_t total_time_ = 0;
+  int64_t min_time_ = std::numeric_limits<int64_t>::max();
+  int64_t max_time_ = 0;
+  TimeHistogram time_histogram_{};
 };
 
 } /* namespace anlnext */
@@ -0,0 +1,155 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_LoopIndexDispatcher_H
+#define ANLNEXT_LoopIndexDispatcher_H 1
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <deque>
+#include <vector>
+#include "CacheAligned.hh"
+
+namespace anlnext
+{
+
+/**
+ * half-open range of loop indices [begin, end).
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+struct LoopIndexRange
+{
+  long int begin = 0;
+  long int end = 0;
+
+  bool empty() const { return (begin >= end); }
+  long int size() const { return (end - begin); }
+};
+
+/**
+ * Dispatcher of loop indices to the analysis chains of the multi-thread mode.
+ * Each chain takes a contiguous range of indices (a chunk) by a single atomic
+ * operation, instead of taking one index at a time under a mutex lock.
+ *
+ * In work-stealing mode, the whole loop is divided into blocks in advance and
+ * each chain owns a deque of ranges. A chain takes chunks from the front of
+ * its own deque, and once it becomes empty, the chain steals ranges from the
+ * back of the deque of the busiest chain.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ * @date 2026-10-18 | work-stealing mode
+ * @date 2026-10-18 | first index of the loop
+ */
+class LoopIndexDispatcher
+{
+public:
+  LoopIndexDispatcher() = default;
+  ~LoopIndexDispatcher();
+  LoopIndexDispatcher(const LoopIndexDispatcher&) = delete;
+  LoopIndexDispatcher(LoopIndexDispatcher&&) = delete;
+  LoopIndexDispatcher& operator=(const LoopIndexDispatcher&) = delete;
+  LoopIndexDispatcher& operator=(LoopIndexDispatcher&&) = delete;
+
+  /**
+   * prepare for a new analysis loop.
+   * @param num_loops number of loops. A negative value means infinite loops.
+   * @param num_chains number of chains that take indices.
+   * @param chunk_size maximum number of indices given at a time.
+   * @param adaptive if true, the chunk size shrinks near the end of the loop.
+   * @param work_stealing if true, work-stealing mode is used. This mode is not
+   * available for infinite loops.
+   * @param first_index first loop index. The indices are given in
+   * [first_index, num_loops).
+   */
+  void reset(long int num_loops, int num_chains,
+             long int chunk_size=1, bool adaptive=false,
+             bool work_stealing=false, long int first_index=0);
+
+  bool is_work_stealing() const { return work_stealing_; }
+
+  /**
+   * take the next range of indices.
+   * @return false if no index is left.
+   */
+  bool take(int chain_index, LoopIndexRange& range);
+
+  /**
+   * return a range of indices that is not processed, e.g., by a chain which
+   * quits the loop. The range will be given to another chain.
+   */
+  void give_back(int chain_index, const LoopIndexRange& range);
+
+  /**
+   * @return true if a range given back is not taken yet.
+   */
+  bool has_returned_ranges();
+
+  /**
+   * @return the first index that has never been given to any chain.
+   */
+  long int next_index() const { return next_index_; }
+
+  /**
+   * @return number of successful steals by the chain.
+   */
+  long int number_of_steals(int chain_index) const;
+
+  /**
+   * @return number of indices that the chain has stolen from the others.
+   */
+  long int number_of_stolen_indices(int chain_index) const;
+
+private:
+  struct alignas(CacheLineSize) ChainQueue
+  {
+    std::mutex mutex;
+    std::deque<LoopIndexRange> ranges;
+    std::atomic<long int> remaining{0};
+    long int steals = 0;
+    long int stolen_indices = 0;
+  };
+
+  long int chunk_size_at(long int index) const;
+  bool take_shared(LoopIndexRange& range);
+  bool take_own(ChainQueue& queue, LoopIndexRange& range);
+  bool steal(int chain_index, LoopIndexRange& range);
+
+private:
+  // the shared index, which every chain updates, has a cache line of its own.
+  alignas(CacheLineSize) std::atomic<long int> next_index_{0};
+  alignas(CacheLineSize) long int last_index_ = 0;
+  int num_chains_ = 1;
+  long int chunk_size_ = 1;
+  bool adaptive_ = false;
+
+  std::atomic<bool> has_returned_ranges_{false};
+  std::mutex mutex_;
+  std::vector<LoopIndexRange> returned_ranges_;
+
+  bool work_stealing_ = false;
+  std::vector<std::unique_ptr<ChainQueue>> queues_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_LoopIndexDispatcher_H */
@@ -0,0 +1,205 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_MPSCRingBuffer_H
+#define ANLNEXT_MPSCRingBuffer_H 1
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace anlnext
+{
+
+/**
+ * Bounded multi-producer single-consumer ring buffer.
+ * Each slot has a sequence number telling whether it is free or filled at
+ * the current lap, so that producers claim slots with one compare-and-swap.
+ * push() and pop() block while the buffer is full or empty, respectively;
+ * a long wait falls back to sleeping, so that an idle consumer does not
+ * occupy a processor.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class MPSCRingBuffer
+{
+public:
+  explicit MPSCRingBuffer(std::size_t capacity=1024);
+  ~MPSCRingBuffer() = default;
+  MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+  MPSCRingBuffer(MPSCRingBuffer&&) = delete;
+  MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+  MPSCRingBuffer& operator=(MPSCRingBuffer&&) = delete;
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+  /**
+   * make the buffer empty and open. Must not be called while in use.
+   */
+  void reset();
+
+  /**
+   * move an element into the buffer. This blocks while the buffer is full.
+   * @return false if the buffer is aborted.
+   */
+  bool push(T&& value);
+
+  /**
+   * move the oldest element out of the buffer. This blocks while the buffer
+   * is empty.
+   * @return false if the buffer is closed and empty, or aborted.
+   */
+  bool pop(T& value);
+
+  /**
+   * notify the consumer that no more element comes. Must be called after
+   * all the producers return from push().
+   */
+  void close() { closed_.store(true, std::memory_order_release); }
+
+  /**
+   * stop both sides immediately.
+   */
+  void abort() { aborted_.store(true, std::memory_order_release); }
+
+  /**
+   * number of push() calls that waited for a free slot.
+   */
+  std::size_t number_of_full_waits() const
+  { return full_waits_.load(std::memory_order_relaxed); }
+
+private:
+  static void pause(int& count);
+
+  struct Slot
+  {
+    std::atomic<std::size_t> sequence{0};
+    T value;
+  };
+
+private:
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t mask_ = 0;
+  alignas(64) std::atomic<std::size_t> write_index_{0};
+  alignas(64) std::size_t read_index_ = 0;
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> aborted_{false};
+  std::atomic<std::size_t> full_waits_{0};
+};
+
+template <typename T>
+MPSCRingBuffer<T>::MPSCRingBuffer(std::size_t capacity)
+{
+  // the capacity is rounded up to a power of two.
+  std::size_t n = 1;
+  while (n < capacity) { n <<= 1; }
+  slots_.reset(new Slot[n]);
+  mask_ = n - 1;
+  reset();
+}
+
+template <typename T>
+void MPSCRingBuffer<T>::reset()
+{
+  for (std::size_t i=0; i<=mask_; i++) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  read_index_ = 0;
+  write_index_.store(0, std::memory_order_relaxed);
+  closed_.store(false, std::memory_order_relaxed);
+  full_waits_.store(0, std::memory_order_relaxed);
+  aborted_.store(false, std::memory_order_release);
+}
+
+template <typename T>
+void MPSCRingBuffer<T>::pause(int& count)
+{
+  if (count < 64) {
+    ++count;
+  }
+  else if (count < 1024) {
+    ++count;
+    std::this_thread::yield();
+  }
+  else {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+template <typename T>
+bool MPSCRingBuffer<T>::push(T&& value)
+{
+  std::size_t w = write_index_.load(std::memory_order_relaxed);
+  int count = 0;
+  while (true) {
+    Slot& slot = slots_[w & mask_];
+    const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence == w) {
+      if (write_index_.compare_exchange_weak(w, w + 1, std::memory_order_relaxed)) {
+        slot.value = std::move(value);
+        slot.sequence.store(w + 1, std::memory_order_release);
+        return true;
+      }
+      // w has been updated by the failed exchange.
+    }
+    else if (sequence < w) {
+      // the slot is still filled at the previous lap.
+      if (aborted_.load(std::memory_order_acquire)) { return false; }
+      if (count == 0) {
+        full_waits_.fetch_add(1, std::memory_order_relaxed);
+      }
+      pause(count);
+      w = write_index_.load(std::memory_order_relaxed);
+    }
+    else {
+      w = write_index_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+bool MPSCRingBuffer<T>::pop(T& value)
+{
+  const std::size_t r = read_index_;
+  Slot& slot = slots_[r & mask_];
+  int count = 0;
+  while (slot.sequence.load(std::memory_order_acquire) != r + 1) {
+    if (aborted_.load(std::memory_order_acquire)) { return false; }
+    if (closed_.load(std::memory_order_acquire)) {
+      // an element might be pushed just before closing.
+      if (slot.sequence.load(std::memory_order_acquire) != r + 1) { return false; }
+      break;
+    }
+    pause(count);
+  }
+  if (aborted_.load(std::memory_order_acquire)) { return false; }
+  value = std::move(slot.value);
+  slot.sequence.store(r + capacity(), std::memory_order_release);
+  read_index_ = r + 1;
+  return true;
+}
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_MPSCRingBuffer_H */
@@ -20,8 +20,9 @@
 #ifndef ANLNEXT_ModuleAccess_H
 #define ANLNEXT_ModuleAccess_H 1
 
+#include <cstddef>
 #include <string>
-#include <map>
+#include <vector>
 #include <iterator>
 #include <boost/format.hpp>
 #include "ANLException.hh"
@@ -38,6 +39,7 @@ class BasicModule;
  * @date 2010-06-xx
  * @date 2016-08-19
  * @date 2017-07-29
+ * @date 2026-10-18 | flat hash table instead of std::map
  */
 class ModuleAccess
 {
@@ -64,14 +66,42 @@ public:
   bool exist(const std::string& name) const;
 
 private:
-  using ANLModuleMap = std::map<std::string, BasicModule*>;
-  ANLModuleMap module_map_;
+  /**
+   * open-addressing hash table from names to modules.
+   */
+  class ModuleTable
+  {
+  public:
+    /**
+     * @return module, or nullptr if the name is not registered.
+     */
+    BasicModule* find(const std::string& name) const;
+    void assign(const std::string& name, BasicModule* module);
+    void erase(const std::string& name);
+
+  private:
+    struct Slot
+    {
+      std::size_t hash = 0;
+      std::string name;
+      BasicModule* module = nullptr;
+    };
+
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+    std::size_t find_slot(const std::string& name, std::size_t hash) const;
+    void rehash(std::size_t capacity);
+
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+  };
+
+  ModuleTable module_table_;
 };
 
 inline
 bool ModuleAccess::exist(const std::string& name) const
 {
-  return (module_map_.find(name) != std::end(module_map_));
+  return (module_table_.find(name) != nullptr);
 }
 
 } /* namespace anlnext */
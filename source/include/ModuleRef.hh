@@ -0,0 +1,65 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ModuleRef_H
+#define ANLNEXT_ModuleRef_H 1
+
+namespace anlnext
+{
+
+class BasicModule;
+
+/**
+ * Reference to another ANL module, resolved once (typically in
+ * mod_initialize()) by BasicModule::get_module() or get_module_NC(), and
+ * then dereferenced in mod_analyze() without any lookup.
+ *
+ * A copy of a reference is unresolved. Since a cloned module is made by
+ * copy, it never points to a module of the master chain, and it has to
+ * resolve the reference in its own chain.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class ModuleRef
+{
+public:
+  ModuleRef() = default;
+  ~ModuleRef() = default;
+  ModuleRef(const ModuleRef&) : ptr_(nullptr) {}
+  ModuleRef& operator=(const ModuleRef&) { ptr_ = nullptr; return *this; }
+
+  T* get() const { return ptr_; }
+  T* operator->() const { return ptr_; }
+  T& operator*() const { return *ptr_; }
+
+  bool is_resolved() const { return (ptr_ != nullptr); }
+  explicit operator bool() const { return is_resolved(); }
+
+  void reset() { ptr_ = nullptr; }
+
+private:
+  friend class BasicModule;
+  T* ptr_ = nullptr;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ModuleRef_H */
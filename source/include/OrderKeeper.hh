@@ -20,6 +20,8 @@
 #ifndef ANLNEXT_OrderKeeper_H
 #define ANLNEXT_OrderKeeper_H 1
 
+#include <cstdint>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
@@ -28,9 +30,14 @@ namespace anlnext
 
 /**
  * OrderKeeper
+ * A lock-free sequencer that lets threads pass in the order of indices.
+ * A waiting thread first spins on the last-done index, and then sleeps on
+ * a futex word selected by its own index, so that send_done() wakes up only
+ * the thread waiting for the next index.
  *
  * @author Hirokazu Odaka
  * @date 2017-07-12
+ * @date 2026-10-18 | lock-free implementation
  */
 class OrderKeeper
 {
@@ -42,6 +49,55 @@ public:
   OrderKeeper& operator=(const OrderKeeper&) = delete;
   OrderKeeper& operator=(OrderKeeper&&) = delete;
 
+  void wait(long int index);
+  void send_done(long int index);
+  void reset(long int first_index=0) { last_done_index_ = first_index - 1; }
+
+  void set_spin_count(int v) { spin_count_ = v; }
+  int spin_count() const { return spin_count_; }
+
+  /**
+   * default number of spins before sleeping.
+   * Spinning is disabled on a single-processor machine.
+   */
+  static int default_spin_count();
+
+private:
+  static constexpr std::size_t NumberOfSlots = 64;
+
+  struct alignas(64) WaitSlot
+  {
+    std::atomic<int32_t> sequence{0};
+    std::atomic<int32_t> waiters{0};
+  };
+
+  WaitSlot& slot(long int index)
+  { return slots_[static_cast<std::size_t>(index) % NumberOfSlots]; }
+
+private:
+  alignas(64) std::atomic<long int> last_done_index_{-1};
+  int spin_count_ = default_spin_count();
+  WaitSlot slots_[NumberOfSlots];
+};
+
+/**
+ * BlockingOrderKeeper
+ * The original implementation of OrderKeeper using a mutex and a condition
+ * variable. Every send_done() wakes up all the waiting threads.
+ *
+ * @author Hirokazu Odaka
+ * @date 2017-07-12
+ */
+class BlockingOrderKeeper
+{
+public:
+  BlockingOrderKeeper() = default;
+  ~BlockingOrderKeeper() = default;
+  BlockingOrderKeeper(const BlockingOrderKeeper&) = delete;
+  BlockingOrderKeeper(BlockingOrderKeeper&&) = delete;
+  BlockingOrderKeeper& operator=(const BlockingOrderKeeper&) = delete;
+  BlockingOrderKeeper& operator=(BlockingOrderKeeper&&) = delete;
+
   void wait(long int index)
   {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -55,6 +111,12 @@ public:
     cv_.notify_all();
   }
 
+  void reset(long int first_index=0)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    last_done_index_ = first_index - 1;
+  }
+
 private:
   std::mutex mutex_;
   std::condition_variable cv_;
@@ -0,0 +1,86 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ParallelLogBuffer_H
+#define ANLNEXT_ParallelLogBuffer_H 1
+
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * Stream buffer that collects the output of concurrent tasks separately.
+ * While an object exists, it replaces the buffer of the given stream.
+ * Characters written by a thread that has attached a slot are stored in the
+ * slot; those by the other threads go to the original buffer. flush() writes
+ * the slots in order, so that the log is the same as if the tasks had run
+ * one by one. If a thread calls std::terminate(), its slot is written before
+ * the program terminates, so that the report of the error is not lost.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class ParallelLogBuffer : public std::streambuf
+{
+public:
+  ParallelLogBuffer(std::ostream& os, std::size_t num_slots);
+  ~ParallelLogBuffer();
+  ParallelLogBuffer(const ParallelLogBuffer&) = delete;
+  ParallelLogBuffer(ParallelLogBuffer&&) = delete;
+  ParallelLogBuffer& operator=(const ParallelLogBuffer&) = delete;
+  ParallelLogBuffer& operator=(ParallelLogBuffer&&) = delete;
+
+  /**
+   * direct the output of the calling thread to the slot.
+   */
+  void attach(std::size_t slot) { current_slot_ = &slots_[slot]; }
+  void detach() { current_slot_ = nullptr; }
+
+  /**
+   * write the contents of the slots in order to the original buffer, and
+   * clear them.
+   */
+  void flush();
+
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+
+private:
+  static void terminate_with_slot();
+
+  std::ostream& stream_;
+  std::streambuf* original_;
+  std::vector<std::string> slots_;
+  std::mutex mutex_;
+  static thread_local std::string* current_slot_;
+  static ParallelLogBuffer* instance_;
+  static std::terminate_handler previous_terminate_handler_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ParallelLogBuffer_H */
@@ -0,0 +1,142 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_PartialReducer_H
+#define ANLNEXT_PartialReducer_H 1
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "ANLStatus.hh"
+#include "CacheAligned.hh"
+
+namespace anlnext
+{
+
+/**
+ * Background reducer of partial results of the chains during an analysis
+ * loop. A reduction is requested every given number of events and/or every
+ * given time interval. Each chain then hands its delta over between two
+ * events and continues the analysis, while the reducer thread merges the
+ * handed-over deltas into the master. A chain does not hand over a new
+ * delta until the previous one has been merged.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class PartialReducer
+{
+public:
+  using MergeFunction = std::function<ANLStatus(int)>;
+
+  PartialReducer() = default;
+  ~PartialReducer();
+  PartialReducer(const PartialReducer&) = delete;
+  PartialReducer(PartialReducer&&) = delete;
+  PartialReducer& operator=(const PartialReducer&) = delete;
+  PartialReducer& operator=(PartialReducer&&) = delete;
+
+  /**
+   * prepare the chain slots. Must not be called while the reducer runs.
+   * @param num_chains number of chains.
+   * @param period number of events between reductions; 0 for none.
+   * @param interval time between reductions in seconds; 0 for none.
+   */
+  void reset(int num_chains, long int period, double interval);
+
+  /**
+   * start the reducer thread if a period or an interval is set.
+   * @param merge function called by the reducer thread with a chain index
+   * to merge the delta of the chain.
+   */
+  void start(MergeFunction merge);
+
+  /**
+   * stop the reducer thread after merging the pending deltas.
+   * @return the first failed status of the merge function. An exception
+   * thrown by the merge function is rethrown here.
+   */
+  ANLStatus stop();
+
+  bool is_active() const { return active_; }
+
+  /**
+   * notify that an event has been processed; requests a reduction when
+   * the event index reaches the end of a period.
+   */
+  void count_up(long int i_event)
+  {
+    if (period_ > 0 && (i_event+1) % period_ == 0) {
+      generation_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * true if the chain should hand its delta over now.
+   */
+  bool is_requested(int chain) const
+  {
+    const Slot& slot = slots_[chain];
+    return slot.generation != generation_.load(std::memory_order_relaxed)
+      && !slot.pending.load(std::memory_order_acquire)
+      && !failed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * notify that the chain has handed its delta over.
+   */
+  void submit(int chain);
+
+  long int number_of_merged_deltas() const { return num_merged_deltas_; }
+
+private:
+  void run(MergeFunction merge);
+  void merge_pending(const MergeFunction& merge, std::unique_lock<std::mutex>& lock);
+
+private:
+  struct alignas(CacheLineSize) Slot
+  {
+    long int generation = 0;
+    std::atomic<bool> pending{false};
+  };
+
+  int num_chains_ = 0;
+  long int period_ = 0;
+  double interval_ = 0.0;
+  bool active_ = false;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(CacheLineSize) std::atomic<long int> generation_{0};
+  std::atomic<bool> failed_{false};
+  long int num_merged_deltas_ = 0;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool submitted_ = false;
+  bool stop_requested_ = false;
+  ANLStatus status_ = AS_OK;
+  std::exception_ptr exception_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_PartialReducer_H */
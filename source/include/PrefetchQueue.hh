@@ -0,0 +1,279 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_PrefetchQueue_H
+#define ANLNEXT_PrefetchQueue_H 1
+
+#include <cstddef>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include "ANLException.hh"
+
+namespace anlnext
+{
+
+/**
+ * Bounded buffer of events read ahead by a background thread.
+ *
+ * The reader thread reads the events in the order of the index into the
+ * slot of index % capacity, waiting while the slot still holds an event
+ * that has not been taken. Any number of chains take the events either by
+ * index in any order, take(), or in the order of reading, take_next().
+ * Since the reader does not overtake an event that is not taken, take()
+ * by an index more than the capacity ahead of the oldest event not taken
+ * waits until that event is taken. The reader is started by the first take
+ * after prepare(), and is called until stop(); the owner must call stop()
+ * before the objects that the reader refers to are destroyed.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class PrefetchQueue
+{
+public:
+  /**
+   * read the event of the index into the object, which holds the event
+   * previously read into the same slot.
+   * @return false if there is no more event.
+   */
+  using Reader = std::function<bool(long int, T&)>;
+
+  explicit PrefetchQueue(std::size_t capacity=256)
+    : slots_(std::max<std::size_t>(capacity, 1))
+  {}
+
+  ~PrefetchQueue() { stop(); }
+  PrefetchQueue(const PrefetchQueue&) = delete;
+  PrefetchQueue(PrefetchQueue&&) = delete;
+  PrefetchQueue& operator=(const PrefetchQueue&) = delete;
+  PrefetchQueue& operator=(PrefetchQueue&&) = delete;
+
+  std::size_t capacity() const { return slots_.size(); }
+
+  /**
+   * enlarge the buffer to the capacity. This stops the reader, and
+   * prepare() should be called before the next take.
+   */
+  void reserve(std::size_t capacity)
+  {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity > slots_.size()) {
+      slots_.resize(capacity);
+    }
+  }
+
+  /**
+   * stop the reader, and make the buffer empty so that the next take()
+   * starts the reader from first_index.
+   */
+  void prepare(long int first_index, Reader reader)
+  {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Slot& slot: slots_) {
+      slot.index = EmptySlot;
+    }
+    first_index_ = first_index;
+    next_index_ = first_index;
+    end_index_ = std::numeric_limits<long int>::max();
+    reader_ = std::move(reader);
+    error_ = nullptr;
+    aborted_ = false;
+    number_of_stalls_ = 0;
+  }
+
+  /**
+   * @return true if the reader thread is running.
+   */
+  bool is_reading() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return thread_.joinable();
+  }
+
+  /**
+   * stop the reader thread. The following take() returns false.
+   */
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      aborted_ = true;
+    }
+    reader_cv_.notify_all();
+    consumer_cv_.notify_all();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  /**
+   * move the event of the index into the object, which is given back to
+   * the slot for reuse. An exception thrown by the reader is rethrown.
+   * @return false if the input ends before the index, or the reader is
+   * stopped.
+   */
+  bool take(long int index, T& event)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (index < first_index_) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("PrefetchQueue: index %d precedes the first index %d") % index % first_index_).str()) );
+    }
+    return take_locked(lock, [index]() { return index; }, event);
+  }
+
+  /**
+   * move the event following the events already taken into the object,
+   * which is given back to the slot for reuse. An exception thrown by the
+   * reader is rethrown.
+   * @return false if the input ends, or the reader is stopped.
+   */
+  bool take_next(T& event)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return take_locked(lock, [this]() { return next_index_; }, event);
+  }
+
+  /**
+   * index following the largest index taken, which is the index to start
+   * from when all the preceding events have been taken.
+   */
+  long int next_index() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_index_;
+  }
+
+  /**
+   * number of takes that waited for the reader.
+   */
+  std::size_t number_of_stalls() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return number_of_stalls_;
+  }
+
+private:
+  static constexpr long int EmptySlot = -1;
+
+  struct Slot
+  {
+    long int index = EmptySlot;
+    T value;
+  };
+
+  template <typename IndexFunction>
+  bool take_locked(std::unique_lock<std::mutex>& lock, IndexFunction index_to_take, T& event)
+  {
+    if (!thread_.joinable() && !aborted_) {
+      thread_ = std::thread(&PrefetchQueue::read_events, this);
+    }
+
+    // the index to take is evaluated again after waking up, since the next
+    // event may have been taken by another consumer.
+    auto ready = [this, &index_to_take]() {
+      const long int index = index_to_take();
+      return (slots_[index % slots_.size()].index == index || index >= end_index_ || aborted_);
+    };
+    if (!ready()) {
+      ++number_of_stalls_;
+      consumer_cv_.wait(lock, ready);
+    }
+
+    const long int index = index_to_take();
+    Slot& slot = slots_[index % slots_.size()];
+    if (slot.index == index) {
+      using std::swap;
+      swap(event, slot.value);
+      slot.index = EmptySlot;
+      next_index_ = std::max(next_index_, index+1);
+      lock.unlock();
+      reader_cv_.notify_one();
+      return true;
+    }
+
+    if (error_ && !aborted_) {
+      std::rethrow_exception(error_);
+    }
+    return false;
+  }
+
+  void read_events()
+  {
+    for (long int i=first_index_; ; i++) {
+      Slot& slot = slots_[i % slots_.size()];
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        reader_cv_.wait(lock, [this, &slot]() { return (slot.index == EmptySlot || aborted_); });
+        if (aborted_) { return; }
+      }
+
+      // the slot is not accessed by the consumers while it is empty.
+      bool read = false;
+      std::exception_ptr error;
+      try {
+        read = reader_(i, slot.value);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (read) {
+          slot.index = i;
+        }
+        else {
+          end_index_ = i;
+          error_ = error;
+        }
+      }
+      consumer_cv_.notify_all();
+      if (!read) { return; }
+    }
+  }
+
+private:
+  std::vector<Slot> slots_;
+  mutable std::mutex mutex_;
+  std::condition_variable reader_cv_;
+  std::condition_variable consumer_cv_;
+  std::thread thread_;
+  Reader reader_;
+  long int first_index_ = 0;
+  long int next_index_ = 0;
+  long int end_index_ = std::numeric_limits<long int>::max();
+  std::exception_ptr error_;
+  bool aborted_ = false;
+  std::size_t number_of_stalls_ = 0;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_PrefetchQueue_H */
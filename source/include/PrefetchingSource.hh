@@ -0,0 +1,230 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_PrefetchingSource_H
+#define ANLNEXT_PrefetchingSource_H 1
+
+#include <cstddef>
+#include <iostream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include "BasicModule.hh"
+#include "PrefetchQueue.hh"
+
+namespace anlnext
+{
+
+/**
+ * Order in which PrefetchingSource gives the events to the chains.
+ *
+ * - loop_index: the event read for a loop index is given to that index.
+ *   The chains must process loop indices within a bounded distance of
+ *   each other; the work-stealing mode of ANLManagerMT is rejected.
+ * - arrival: each chain takes the next event read, whatever its loop
+ *   index. This works with any dispatch of loop indices.
+ */
+enum class PrefetchOrder
+{
+  loop_index, arrival
+};
+
+/**
+ * Base class of a source module that reads the events on a background
+ * thread ahead of the loop index, so that the reading overlaps with the
+ * analysis of the chains.
+ *
+ * A derived class implements read_event(), which is called on the reader
+ * thread in the order of the index, and analyze_event(), which is called
+ * in mod_analyze() with the event taken for the loop index. The clones of
+ * the module share the buffer of the master, so that all the chains of
+ * ANLManagerMT pull the events from one reader. mod_analyze() returns
+ * AS_QUIT when the input ends.
+ *
+ * In the loop-index order, the buffer is enlarged at mod_begin_run() to
+ * twice the span of loop indices that the chains may process at the same
+ * time (BasicModule::loop_index_span()), since the reader does not overtake
+ * an event that is not taken. The module should be the first one of the
+ * chain; an index that is never taken, e.g., skipped by a preceding module,
+ * stops the reader when the buffer wraps around to it. The arrival order
+ * has neither of these limitations.
+ *
+ * The reader thread is stopped by mod_end_run() or mod_finalize(). Since
+ * they are not called when the analysis fails, the destructor of a derived
+ * class must call stop_reader(). A derived class that overrides the
+ * mod_*() methods defined here should call them of this class.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename EventType>
+class PrefetchingSource : public BasicModule
+{
+public:
+  explicit PrefetchingSource(std::size_t prefetch_size=256)
+    : queue_(std::make_shared<PrefetchQueue<EventType>>(prefetch_size))
+  {}
+
+  ~PrefetchingSource()
+  {
+    // the reader thread calls read_event() of the derived class, which has
+    // already been destroyed here.
+    if (is_master() && queue_->is_reading()) {
+      std::cerr << module_id() << ": the reader thread is not stopped by the destructor of the derived class" << std::endl;
+      stop_reader();
+    }
+  }
+
+protected:
+  PrefetchingSource(const PrefetchingSource& r)
+    : BasicModule(r),
+      queue_(r.queue_),
+      prefetch_order_(r.prefetch_order_)
+  {}
+
+public:
+  /**
+   * set the order of the events. This should be set before mod_begin_run().
+   */
+  void set_prefetch_order(PrefetchOrder v) { prefetch_order_ = v; }
+  PrefetchOrder prefetch_order() const { return prefetch_order_; }
+
+  ANLStatus mod_begin_run() override
+  {
+    current_index_ = -1;
+    if (is_master()) {
+      if (prefetch_order_ == PrefetchOrder::loop_index) {
+        const long int span = loop_index_span();
+        if (span < 0) {
+          BOOST_THROW_EXCEPTION( ANLException(this, "Loop indices are not given within a bounded span (work-stealing mode); use PrefetchOrder::arrival") );
+        }
+        const std::size_t size = 2 * static_cast<std::size_t>(span);
+        if (size > queue_->capacity()) {
+          std::cout << module_id() << ": prefetch size is enlarged to " << size
+                    << " for the span of loop indices" << std::endl;
+          queue_->reserve(size);
+        }
+      }
+      prepare_reader(0);
+    }
+    return AS_OK;
+  }
+
+  ANLStatus mod_analyze() override
+  {
+    const long int index = get_loop_index();
+    if (index != current_index_) {
+      const bool taken = (prefetch_order_ == PrefetchOrder::loop_index)
+        ? queue_->take(index, current_event_)
+        : queue_->take_next(current_event_);
+      if (!taken) {
+        return AS_QUIT;
+      }
+      current_index_ = index;
+    }
+    return analyze_event(current_event_);
+  }
+
+  ANLStatus mod_end_run() override
+  {
+    stop_reader();
+    return AS_OK;
+  }
+
+  ANLStatus mod_finalize() override
+  {
+    stop_reader();
+    return AS_OK;
+  }
+
+  ANLStatus mod_save_state(std::ostream& state) override
+  {
+    const long int next_index = queue_->next_index();
+    state.write(reinterpret_cast<const char*>(&next_index), sizeof(next_index));
+    return AS_OK;
+  }
+
+  ANLStatus mod_restore_state(std::istream& state) override
+  {
+    long int next_index = 0;
+    if (!state.read(reinterpret_cast<char*>(&next_index), sizeof(next_index))) {
+      return AS_ERROR;
+    }
+    if (is_master()) {
+      prepare_reader(next_index);
+    }
+    return AS_OK;
+  }
+
+  std::size_t prefetch_size() const { return queue_->capacity(); }
+
+  /**
+   * number of events for which the chains waited for the reader.
+   */
+  std::size_t number_of_prefetch_stalls() const { return queue_->number_of_stalls(); }
+
+protected:
+  /**
+   * read the event of the index, which is the loop index in the loop-index
+   * order, or the number of events read before in the arrival order. This
+   * is called on the reader thread, and should not access the state used by
+   * the analysis loop.
+   * @return false if there is no more event.
+   */
+  virtual bool read_event(long int index, EventType& event) = 0;
+
+  /**
+   * process the event of the current loop index in mod_analyze().
+   */
+  virtual ANLStatus analyze_event(EventType&) { return AS_OK; }
+
+  const EventType& current_event() const { return current_event_; }
+  EventType& current_event() { return current_event_; }
+
+  /**
+   * stop the reader thread of the master. The events read ahead are
+   * discarded. This does nothing for a clone, or if the thread is not
+   * running.
+   */
+  void stop_reader()
+  {
+    if (is_master()) {
+      queue_->stop();
+    }
+  }
+
+private:
+  void prepare_reader(long int first_index)
+  {
+    queue_->prepare(first_index,
+                    [this](long int index, EventType& event) {
+                      return read_event(index, event);
+                    });
+  }
+
+private:
+  std::shared_ptr<PrefetchQueue<EventType>> queue_;
+  PrefetchOrder prefetch_order_ = PrefetchOrder::loop_index;
+  long int current_index_ = -1;
+  EventType current_event_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_PrefetchingSource_H */
@@ -0,0 +1,109 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ProgressReporter_H
+#define ANLNEXT_ProgressReporter_H 1
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CacheAligned.hh"
+
+namespace anlnext
+{
+
+/**
+ * Background reporter of the progress of an analysis loop.
+ * Each chain counts up its own progress counter, and a reporter thread
+ * samples the counters periodically to print the number of processed
+ * events, the event rate, the estimated time to finish, and the rates of
+ * the chains.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class ProgressReporter
+{
+public:
+  ProgressReporter() = default;
+  ~ProgressReporter();
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter(ProgressReporter&&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(ProgressReporter&&) = delete;
+
+  /**
+   * prepare the counters. Must not be called while the reporter runs.
+   * @param num_counters number of progress counters (chains).
+   * @param num_events total number of events; negative if unknown.
+   */
+  void reset(int num_counters, long int num_events);
+
+  /**
+   * start the reporter thread.
+   * @param interval reporting interval in seconds.
+   */
+  void start(double interval, std::ostream& os=std::cout);
+
+  /**
+   * stop the reporter thread and wait for it.
+   */
+  void stop();
+
+  /**
+   * count up a processed event. Each counter must be counted by one thread.
+   */
+  void count_up(int index)
+  {
+    std::atomic<long int>& c = counters_[index].count;
+    c.store(c.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+  }
+
+  long int count(int index) const
+  { return counters_[index].count.load(std::memory_order_relaxed); }
+
+  int number_of_counters() const { return num_counters_; }
+
+private:
+  void run(double interval, std::ostream& os);
+  void report(double elapsed, double interval, std::vector<long int>& previous, std::ostream& os);
+
+private:
+  struct alignas(CacheLineSize) Counter
+  {
+    std::atomic<long int> count{0};
+  };
+
+  int num_counters_ = 0;
+  long int num_events_ = 0;
+  std::unique_ptr<Counter[]> counters_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_requested_ = false;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ProgressReporter_H */
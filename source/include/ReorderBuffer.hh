@@ -0,0 +1,127 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ReorderBuffer_H
+#define ANLNEXT_ReorderBuffer_H 1
+
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include "ANLStatus.hh"
+
+namespace anlnext
+{
+
+/**
+ * Bounded reorder buffer between the parallel part (head) and the
+ * order-sensitive part (tail) of the analysis chains.
+ *
+ * A producer thread acquires a free chain, processes the head of an event
+ * with it, and pushes an entry (loop index, chain, status) into the buffer.
+ * A single consumer pops the entries in the order of loop indices, processes
+ * the tail with the same chain, and then releases the chain. Since a chain
+ * is held from the head to the tail of an event, the number of chains bounds
+ * the number of events in the buffer.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ * @date 2026-10-18 | first index of the loop
+ */
+class ReorderBuffer
+{
+public:
+  struct Entry
+  {
+    long int index = -1;
+    int chain = -1;
+    ANLStatus status = ANLStatus::ok;
+  };
+
+public:
+  ReorderBuffer() = default;
+  ~ReorderBuffer();
+  ReorderBuffer(const ReorderBuffer&) = delete;
+  ReorderBuffer(ReorderBuffer&&) = delete;
+  ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+  ReorderBuffer& operator=(ReorderBuffer&&) = delete;
+
+  /**
+   * prepare for a new analysis loop.
+   * @param num_chains number of chains, all of which become free.
+   * @param num_producers number of producer threads.
+   * @param first_index first loop index, which is popped first.
+   */
+  void reset(int num_chains, int num_producers, long int first_index=0);
+
+  /**
+   * take a free chain. This blocks until a chain is released.
+   * @return chain index, or -1 if the buffer is aborted or no chain is alive.
+   */
+  int acquire_chain();
+
+  /**
+   * make the chain free again.
+   */
+  void release_chain(int chain);
+
+  /**
+   * take the chain out of service, e.g., after it returned quit.
+   */
+  void retire_chain(int chain);
+
+  /**
+   * take a free chain out of service, e.g., a chain that returned quit in
+   * a previous range of the loop.
+   */
+  void retire_free_chain(int chain);
+
+  void push(const Entry& entry);
+
+  /**
+   * take the entry of the next loop index. This blocks until it arrives.
+   * @return false if no more entry comes, or the buffer is aborted.
+   */
+  bool pop_next(Entry& entry);
+
+  /**
+   * notify that a producer thread finishes.
+   */
+  void close_producer();
+
+  /**
+   * stop all the waiting threads, e.g., due to an exception.
+   */
+  void abort();
+
+private:
+  std::mutex mutex_;
+  std::condition_variable chain_cv_;
+  std::condition_variable entry_cv_;
+  std::vector<int> free_chains_;
+  int num_live_chains_ = 0;
+  std::vector<Entry> entries_;
+  std::vector<bool> occupied_;
+  long int next_index_ = 0;
+  int num_producers_ = 0;
+  bool aborted_ = false;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ReorderBuffer_H */
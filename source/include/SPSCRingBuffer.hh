@@ -0,0 +1,157 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_SPSCRingBuffer_H
+#define ANLNEXT_SPSCRingBuffer_H 1
+
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * Bounded single-producer single-consumer ring buffer.
+ * push() and pop() block while the buffer is full or empty, respectively.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+template <typename T>
+class SPSCRingBuffer
+{
+public:
+  explicit SPSCRingBuffer(std::size_t capacity=64);
+  ~SPSCRingBuffer() = default;
+  SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+  SPSCRingBuffer(SPSCRingBuffer&&) = delete;
+  SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+  SPSCRingBuffer& operator=(SPSCRingBuffer&&) = delete;
+
+  std::size_t capacity() const { return slots_.size(); }
+
+  /**
+   * make the buffer empty and open. Must not be called while in use.
+   */
+  void reset();
+
+  /**
+   * copy an element into the buffer. This blocks while the buffer is full.
+   * @return false if the buffer is aborted.
+   */
+  bool push(const T& value);
+
+  /**
+   * copy the oldest element out of the buffer. This blocks while the buffer
+   * is empty.
+   * @return false if the buffer is closed and empty, or aborted.
+   */
+  bool pop(T& value);
+
+  /**
+   * notify the consumer that no more element comes.
+   */
+  void close() { closed_.store(true, std::memory_order_release); }
+
+  /**
+   * stop both sides immediately.
+   */
+  void abort() { aborted_.store(true, std::memory_order_release); }
+
+private:
+  static void pause(int& count);
+
+private:
+  std::vector<T> slots_;
+  std::size_t mask_ = 0;
+  alignas(64) std::atomic<std::size_t> read_index_{0};
+  alignas(64) std::atomic<std::size_t> write_index_{0};
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> aborted_{false};
+};
+
+template <typename T>
+SPSCRingBuffer<T>::SPSCRingBuffer(std::size_t capacity)
+{
+  // the capacity is rounded up to a power of two.
+  std::size_t n = 1;
+  while (n < capacity) { n <<= 1; }
+  slots_.resize(n);
+  mask_ = n - 1;
+}
+
+template <typename T>
+void SPSCRingBuffer<T>::reset()
+{
+  read_index_.store(0, std::memory_order_relaxed);
+  write_index_.store(0, std::memory_order_relaxed);
+  closed_.store(false, std::memory_order_relaxed);
+  aborted_.store(false, std::memory_order_release);
+}
+
+template <typename T>
+void SPSCRingBuffer<T>::pause(int& count)
+{
+  if (count < 64) {
+    ++count;
+  }
+  else {
+    std::this_thread::yield();
+  }
+}
+
+template <typename T>
+bool SPSCRingBuffer<T>::push(const T& value)
+{
+  const std::size_t w = write_index_.load(std::memory_order_relaxed);
+  int count = 0;
+  while (w - read_index_.load(std::memory_order_acquire) == slots_.size()) {
+    if (aborted_.load(std::memory_order_acquire)) { return false; }
+    pause(count);
+  }
+  slots_[w & mask_] = value;
+  write_index_.store(w + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool SPSCRingBuffer<T>::pop(T& value)
+{
+  const std::size_t r = read_index_.load(std::memory_order_relaxed);
+  int count = 0;
+  while (write_index_.load(std::memory_order_acquire) == r) {
+    if (aborted_.load(std::memory_order_acquire)) { return false; }
+    if (closed_.load(std::memory_order_acquire)) {
+      // an element might be pushed just before closing.
+      if (write_index_.load(std::memory_order_acquire) == r) { return false; }
+      break;
+    }
+    pause(count);
+  }
+  if (aborted_.load(std::memory_order_acquire)) { return false; }
+  value = slots_[r & mask_];
+  read_index_.store(r + 1, std::memory_order_release);
+  return true;
+}
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_SPSCRingBuffer_H */
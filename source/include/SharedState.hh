@@ -0,0 +1,95 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_SharedState_H
+#define ANLNEXT_SharedState_H 1
+
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <boost/format.hpp>
+#include "ANLException.hh"
+
+namespace anlnext
+{
+
+/**
+ * Immutable objects shared by a master module and its clones.
+ * The master module publishes objects until the state is frozen (after its
+ * mod_initialize()); then the clones read them concurrently.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class SharedState
+{
+public:
+  SharedState() = default;
+  ~SharedState() = default;
+  SharedState(const SharedState&) = delete;
+  SharedState(SharedState&&) = delete;
+  SharedState& operator=(const SharedState&) = delete;
+  SharedState& operator=(SharedState&&) = delete;
+
+  template <typename T>
+  void publish(const std::string& name, std::shared_ptr<const T> object)
+  {
+    if (frozen_) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("Shared state is frozen ===> %s") % name).str()) );
+    }
+    entries_.insert_or_assign(name, Entry{std::move(object), std::type_index(typeid(T))});
+  }
+
+  template <typename T>
+  std::shared_ptr<const T> get(const std::string& name) const
+  {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("Shared state is not found ===> %s") % name).str()) );
+    }
+    if (it->second.type != std::type_index(typeid(T))) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("Shared state has a different type ===> %s") % name).str()) );
+    }
+    return std::static_pointer_cast<const T>(it->second.object);
+  }
+
+  bool contains(const std::string& name) const
+  { return entries_.count(name) > 0; }
+
+  std::size_t size() const { return entries_.size(); }
+
+  void freeze() { frozen_ = true; }
+  void unfreeze() { frozen_ = false; }
+  bool is_frozen() const { return frozen_; }
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<const void> object;
+    std::type_index type;
+  };
+
+  std::map<std::string, Entry> entries_;
+  bool frozen_ = false;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_SharedState_H */
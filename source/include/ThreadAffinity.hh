@@ -0,0 +1,109 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_ThreadAffinity_H
+#define ANLNEXT_ThreadAffinity_H 1
+
+#include <string>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * Policy to assign CPUs to the analysis threads.
+ *
+ * - none: threads are not pinned.
+ * - compact: threads fill the CPUs in order, i.e., the hardware threads of a
+ *   core, then the cores of a socket, then the next socket.
+ * - scatter: threads are spread over the sockets first, then over the
+ *   cores, so that they share as few resources as possible.
+ * - explicit_list: the i-th thread runs on the i-th CPU of the given list.
+ */
+enum class AffinityPolicy
+{
+  none, compact, scatter, explicit_list
+};
+
+/**
+ * CPU assignment of the analysis threads.
+ * The thread of index i is pinned to cpu(i); if there are more threads than
+ * CPUs, the CPUs are reused in the same order.
+ * Pinning is supported on Linux; it does nothing on the other platforms.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class ThreadAffinity
+{
+public:
+  ThreadAffinity() = default;
+  ~ThreadAffinity() = default;
+  ThreadAffinity(const ThreadAffinity&) = default;
+  ThreadAffinity(ThreadAffinity&&) = default;
+  ThreadAffinity& operator=(const ThreadAffinity&) = default;
+  ThreadAffinity& operator=(ThreadAffinity&&) = default;
+
+  void set_policy(AffinityPolicy v) { policy_ = v; }
+  AffinityPolicy policy() const { return policy_; }
+  bool is_enabled() const { return policy_ != AffinityPolicy::none; }
+
+  /**
+   * set the policy by name: "none", "compact", "scatter", or "explicit".
+   */
+  void set_policy(const std::string& name);
+  std::string policy_name() const;
+
+  /**
+   * set the CPU list, which is used by the explicit_list policy.
+   */
+  void set_cpu_list(const std::vector<int>& v) { cpu_list_ = v; }
+  const std::vector<int>& cpu_list() const { return cpu_list_; }
+
+  /**
+   * determine the order of the CPUs by the policy.
+   * An ANLException is thrown if the explicit list is invalid.
+   */
+  void setup();
+
+  /**
+   * @return CPU assigned to the thread, or -1 if the threads are not pinned.
+   */
+  int cpu(int thread_index) const;
+
+  /**
+   * pin the calling thread to the CPU assigned to the given thread index.
+   * @return false if pinning failed or is not supported.
+   */
+  bool pin_current_thread(int thread_index) const;
+
+  /**
+   * @return CPUs that the process is allowed to run on.
+   */
+  static std::vector<int> available_cpus();
+
+private:
+  AffinityPolicy policy_ = AffinityPolicy::none;
+  std::vector<int> cpu_list_;
+  std::vector<int> cpu_order_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_ThreadAffinity_H */
@@ -0,0 +1,100 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef ANLNEXT_WorkerPool_H
+#define ANLNEXT_WorkerPool_H 1
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace anlnext
+{
+
+/**
+ * Fixed set of worker threads that live until stop() or destruction.
+ * Each task is given to a particular worker, so that a worker can keep
+ * working on the same data (e.g., a chain) with warm caches.
+ *
+ * @author Hirokazu Odaka
+ * @date 2026-10-18
+ */
+class WorkerPool
+{
+public:
+  WorkerPool() = default;
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  WorkerPool& operator=(WorkerPool&&) = delete;
+
+  /**
+   * (re)create the workers.
+   * @param initializer function called by each worker with its index when
+   * it starts, e.g., to set the CPU affinity.
+   */
+  void start(int num_workers, std::function<void(int)> initializer=nullptr);
+
+  /**
+   * stop and join all the workers.
+   */
+  void stop();
+
+  int size() const { return static_cast<int>(workers_.size()); }
+
+  /**
+   * run task(i) on every worker i and wait for all of them.
+   * If a task throws, the exception is rethrown here after all the tasks
+   * have finished.
+   */
+  void run_all(const std::function<void(int)>& task);
+
+  /**
+   * run the task on the given worker and wait for it.
+   */
+  void run_one(int index, const std::function<void()>& task);
+
+private:
+  void run(int index, std::function<void(int)> initializer);
+  void wait_for_tasks(std::unique_lock<std::mutex>& lock);
+
+private:
+  struct Worker
+  {
+    std::thread thread;
+    std::function<void()> task;
+    bool has_task = false;
+  };
+
+  std::vector<Worker> workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_task_;
+  std::condition_variable cv_done_;
+  int num_pending_ = 0;
+  bool stopping_ = false;
+  std::exception_ptr exception_;
+};
+
+} /* namespace anlnext */
+
+#endif /* ANLNEXT_WorkerPool_H */
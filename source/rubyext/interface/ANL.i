@@ -2,6 +2,7 @@
 %{
 #include "ANLManager.hh"
 #include "ANLManagerMT.hh"
+#include "ANLManagerPipeline.hh"
 #include "VModuleParameter.hh"
 #include "BasicModule.hh"
 #include "ANLException.hh"
@@ -153,6 +154,12 @@ class BasicModule
 
   void set_order_sensitive(bool v);
   bool is_order_sensitive() const;
+  void set_associative_merge(bool v=true);
+  bool is_associative_merge() const;
+  void set_partial_reduction(bool v=true);
+  bool is_partial_reduction() const;
+  void set_batch_analysis(bool v=true);
+  bool is_batch_analysis() const;
 
   void set_singleton(int copyID);
   void unset_singleton();
@@ -259,6 +266,13 @@ class ANLManager
 
   void set_display_period(long int v);
   int display_period() const;
+  void set_progress_report_interval(double v);
+  double progress_report_interval() const;
+
+  void set_module_timing(bool v=true);
+  bool module_timing() const;
+  void set_batch_size(long int v);
+  long int batch_size() const;
   
   void set_modules(std::vector<anlnext::BasicModule*> modules);
 
@@ -275,6 +289,15 @@ class ANLManager
 
   void parameters_to_json(const std::string& filename) const;
 
+  double analysis_time() const;
+  void statistics_to_json(const std::string& filename) const;
+
+  void set_checkpoint(const std::string& filename, long int period);
+  std::string checkpoint_file() const;
+  long int checkpoint_period() const;
+  void set_resume_file(const std::string& filename);
+  std::string resume_file() const;
+
   virtual ANLStatus do_interactive_comunication();
   virtual ANLStatus do_interactive_analysis();
 
@@ -286,6 +309,43 @@ class ANLManagerMT : public ANLManager
 public:
   explicit ANLManagerMT(int num_parallels=1);
   virtual ~ANLManagerMT();
+
+  void set_chunk_size(long int v);
+  long int chunk_size() const;
+  void set_adaptive_chunk(bool v=true);
+  bool is_adaptive_chunk() const;
+  void set_work_stealing(bool v=true);
+  bool is_work_stealing() const;
+  void set_reorder_buffer_size(int v);
+  int reorder_buffer_size() const;
+  int number_of_chains() const;
+  int number_of_threads() const;
+  void set_parallel_routines(bool v=true);
+  bool is_parallel_routines() const;
+  void set_partial_reduction_period(long int v);
+  long int partial_reduction_period() const;
+  void set_partial_reduction_interval(double v);
+  double partial_reduction_interval() const;
+  long int number_of_merged_deltas() const;
+  void set_parallel_segment(const std::string& first_module_id,
+                            const std::string& last_module_id);
+  bool is_hybrid_mode() const;
+  void set_thread_affinity(const std::string& policy);
+  std::string thread_affinity() const;
+  void set_thread_affinity_cpus(const std::vector<int>& cpus);
+};
+
+class ANLManagerPipeline : public ANLManager
+{
+public:
+  ANLManagerPipeline();
+  virtual ~ANLManagerPipeline();
+
+  void define_stage_boundary(const std::string& module_id);
+  void clear_stage_boundaries();
+  int number_of_stages() const;
+  void set_buffer_size(std::size_t v);
+  std::size_t buffer_size() const;
 };
  
 } /* namespace anlnext */
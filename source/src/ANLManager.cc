@@ -25,6 +25,7 @@
 #include <memory>
 #include <thread>
 #include <cctype>
+#include <chrono>
 
 #if ANLNEXT_ANALYZE_INTERRUPT || ANL_INITIALIZE_INTERRUPT || ANL_FINALIZE_INTERRUPT
 #include <csignal>
@@ -36,10 +37,13 @@
 
 #include "BasicModule.hh"
 #include "EvsManager.hh"
+#include "EventDataBus.hh"
+#include "EventArena.hh"
 #include "ModuleAccess.hh"
 #include "ANLException.hh"
 #include "ANLManager_impl.hh"
 #include "OrderKeeper.hh"
+#include "Checkpoint.hh"
 
 #if ANLNEXT_USE_READLINE
 #include <unistd.h>
@@ -63,6 +67,8 @@ ANLManager::ANLManager()
   : print_clone_parameters_(false),
     num_events_(0),
     evs_manager_(new EvsManager),
+    event_data_bus_(new EventDataBus),
+    event_arena_(new EventArena),
     requested_(ANLRequest::none),
     exception_propagation_(true),
     display_period_(-1),
@@ -80,6 +86,8 @@ void ANLManager::set_modules(std::vector<BasicModule*> modules)
 
   for (BasicModule* mod: modules_) {
     mod->set_evs_manager(evs_manager_.get());
+    mod->set_event_data_bus(event_data_bus_.get());
+    mod->set_event_arena(event_arena_.get());
     mod->set_module_access(module_access_.get());
   }
 
@@ -94,6 +102,20 @@ long int ANLManager::display_period() const
   return display_period_;
 }
 
+double ANLManager::progress_report_interval() const
+{
+  if (progress_report_interval_ < 0.0) {
+    return (display_period() != 0) ? default_progress_report_interval() : 0.0;
+  }
+  return progress_report_interval_;
+}
+
+void ANLManager::set_checkpoint(const std::string& filename, long int period)
+{
+  checkpoint_file_ = filename;
+  checkpoint_period_ = (period > 0) ? period : 0;
+}
+
 ANLStatus ANLManager::Define()
 {
   std::cout << '\n'
@@ -156,6 +178,9 @@ ANLStatus ANLManager::PreInitialize()
     goto final;
   }
 
+  // the slots are defined up to mod_pre_initialize(), and the clones copy
+  // the layout.
+  event_data_bus_->allocate();
   duplicate_chains();
 
   final:
@@ -235,6 +260,14 @@ ANLStatus ANLManager::Analyze(long int num_events, bool enable_console)
 
   ANLStatus status = AS_OK;
 
+  apply_module_timing();
+  entries_at_start_ = counters_.empty() ? 0 : counters_.front().entry();
+  analysis_time_ = 0.0;
+  progress_.reset(number_of_progress_counters(), num_events);
+  for (BasicModule* mod: modules_) {
+    mod->set_loop_index_span(loop_index_span());
+  }
+
   status = routine_begin_run();
   if (status != AS_OK) {
     goto final;
@@ -253,6 +286,8 @@ ANLStatus ANLManager::Analyze(long int num_events, bool enable_console)
     analysis_thread_finished_ = false;
     std::thread interactive_thread(std::bind(&ANLManager::interactive_session, this));
 
+    analysis_start_ = std::chrono::steady_clock::now();
+
     const bool use_analysis_thread = false;
     if (use_analysis_thread) {
       std::promise<ANLStatus> status_promise;
@@ -265,8 +300,9 @@ ANLStatus ANLManager::Analyze(long int num_events, bool enable_console)
       status = status_future.get();
     }
     else {
-      status = process_analysis();
+      status = process_analysis_with_progress_report();
     }
+    analysis_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - analysis_start_).count();
     analysis_thread_finished_ = true;
     interactive_thread.join();
   }
@@ -274,7 +310,9 @@ ANLStatus ANLManager::Analyze(long int num_events, bool enable_console)
     std::cout << "\n"
               << "ANLManager: starting analysis loop.\n"
               << std::endl;
-    status = process_analysis();
+    analysis_start_ = std::chrono::steady_clock::now();
+    status = process_analysis_with_progress_report();
+    analysis_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - analysis_start_).count();
   }
 
   if (status != AS_OK) {
@@ -461,16 +499,27 @@ void ANLManager::reset_counters()
   }
 }
 
+void ANLManager::apply_module_timing()
+{
+  for (LoopCounter& c: counters_) {
+    c.set_timing_enabled(module_timing_);
+  }
+}
+
 ANLStatus ANLManager::process_analysis()
 {
   ANLStatus status = AS_OK;
 
   const std::vector<BasicModule*>& modules = modules_;
   const long int period_disp = display_period();
-  const long int num_events = number_of_loops();
+  const long int last_event = loop_end();
 
   try {
-    for (long int i_event=0; i_event!=num_events; i_event++) {
+    if (batch_size() > 1) {
+      return process_analysis_in_batches();
+    }
+
+    for (long int i_event=loop_begin(); i_event!=last_event; i_event++) {
       if (period_disp != 0 && i_event%period_disp == 0) {
         print_event_index(i_event);
       }
@@ -482,6 +531,8 @@ ANLStatus ANLManager::process_analysis()
       }
 
       if (status==AS_QUIT || status==AS_QUIT_ALL) {
+        // the rest of the loop after a checkpoint is not processed either.
+        requested_ = ANLRequest::quit;
         break;
       }
 
@@ -505,7 +556,10 @@ ANLStatus ANLManager::process_analysis()
       }
       else if (status==ANLStatus::redo) {
         i_event--;
+        continue;
       }
+
+      progress_.count_up(0);
     }
   }
   catch (ANLException& ex) {
@@ -532,6 +586,71 @@ ANLStatus ANLManager::process_analysis()
   return AS_OK;
 }
 
+ANLStatus ANLManager::process_analysis_in_batches()
+{
+  const long int period_disp = display_period();
+  const long int last_event = loop_end();
+  EventBatch batch;
+
+  long int first_index = loop_begin();
+  while (first_index != last_event) {
+    long int num_events = batch_size();
+    if (last_event >= 0 && last_event - first_index < num_events) {
+      num_events = last_event - first_index;
+    }
+
+    const std::size_t num_processed
+      = process_event_batch(first_index, num_events, modules_, counters_, *evs_manager_, batch);
+    // a batch that ends with an event to redo is continued after the event.
+    if (batch.statuses[num_processed-1] == ANLStatus::redo) {
+      num_events = num_processed;
+    }
+
+    for (std::size_t i=0; i<num_processed; i++) {
+      const long int i_event = first_index + i;
+      if (period_disp != 0 && i_event%period_disp == 0) {
+        print_event_index(i_event);
+      }
+
+      ANLStatus status = batch.statuses[i];
+      while (status == ANLStatus::redo) {
+        status = process_one_event(i_event, modules_, counters_, *evs_manager_);
+      }
+
+      if (is_critical_error(status)) {
+        return status;
+      }
+
+      if (status==AS_QUIT || status==AS_QUIT_ALL) {
+        requested_ = ANLRequest::quit;
+        return AS_OK;
+      }
+
+      progress_.count_up(0);
+    }
+
+    if (requested_ != ANLRequest::none) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const long int i_event = first_index + num_events - 1;
+      if (requested_ == ANLRequest::quit) {
+        break;
+      }
+      else if (requested_ == ANLRequest::show_event_index) {
+        print_event_index(i_event);
+      }
+      else if (requested_ == ANLRequest::show_evs_summary) {
+        print_event_index(i_event);
+        evs_manager_->print_summary();
+      }
+      requested_ = ANLRequest::none;
+    }
+
+    first_index += num_events;
+  }
+
+  return AS_OK;
+}
+
 void ANLManager::print_summary()
 {
   const std::size_t n = modules_.size();
@@ -560,6 +679,53 @@ void ANLManager::print_summary()
   }
   std::cout << "               Get: " << counters_[n-1].ok() << '\n';
   std::cout << std::endl;
+
+  const std::size_t arena_peak = event_arena_peak_usage();
+  if (arena_peak > 0) {
+    std::cout << "<Event arena>\n"
+              << "  peak usage per event: " << arena_peak << " bytes\n"
+              << std::endl;
+  }
+
+  if (module_timing_) {
+    print_timing_summary();
+  }
+}
+
+void ANLManager::print_timing_summary()
+{
+  std::cout << "<Module timing> (mod_analyze, summed over all chains)\n"
+            << "    [   i]  module ID                      |   calls    |  total (s)  | mean (us) |  min (us) |  max (us)\n"
+            << "-------------------------------------------------------------------------------------------------------------\n";
+  const std::size_t n = modules_.size();
+  for (std::size_t i=0; i<n; i++) {
+    const LoopCounter& c = counters_[i];
+    std::cout << boost::format("    [%4d]  %-30s | %10d | %11.4f | %9.3f | %9.3f | %9.3f\n")
+      % i
+      % modules_[i]->module_id()
+      % c.timed()
+      % (1.0e-9*c.total_time())
+      % (1.0e-3*c.mean_time())
+      % (1.0e-3*c.min_time())
+      % (1.0e-3*c.max_time());
+
+    const LoopCounter::TimeHistogram& h = c.time_histogram();
+    int first = 0, last = -1;
+    for (int k=0; k<LoopCounter::NumTimeBins; k++) {
+      if (h[k] > 0) {
+        if (last < 0) { first = k; }
+        last = k;
+      }
+    }
+    if (last >= 0) {
+      std::cout << "            latency histogram, log2(ns) from " << first << ':';
+      for (int k=first; k<=last; k++) {
+        std::cout << ' ' << h[k];
+      }
+      std::cout << '\n';
+    }
+  }
+  std::cout << std::endl;
 }
 
 boost::property_tree::ptree ANLManager::parameters_to_property_tree() const
@@ -579,6 +745,36 @@ void ANLManager::parameters_to_json(const std::string& filename) const
   write_json(filename.c_str(), pt);
 }
 
+boost::property_tree::ptree ANLManager::statistics_to_property_tree() const
+{
+  boost::property_tree::ptree pt;
+  const long int num_put = counters_.empty() ? 0 : counters_.front().entry();
+  const long int num_get = counters_.empty() ? 0 : counters_.back().ok();
+  const long int num_processed = num_put - entries_at_start_;
+  pt.put("statistics.number_of_loops", number_of_loops());
+  pt.put("statistics.number_of_parallels", number_of_parallels());
+  pt.put("statistics.processed", num_processed);
+  pt.put("statistics.analysis_time", analysis_time_);
+  pt.put("statistics.throughput", (analysis_time_ > 0.0) ? num_processed/analysis_time_ : 0.0);
+  pt.put("statistics.put", num_put);
+  pt.put("statistics.get", num_get);
+
+  boost::property_tree::ptree pt_modules;
+  for (std::size_t i=0; i<modules_.size() && i<counters_.size(); i++) {
+    pt_modules.push_back(std::make_pair("", module_counter_to_property_tree(*modules_[i], counters_[i])));
+  }
+  pt.add_child("statistics.module_list", std::move(pt_modules));
+  pt.add_child("statistics.evs_list", evs_manager_->summary_to_property_tree());
+  pt.put("statistics.event_arena_peak_usage", event_arena_peak_usage());
+  return pt;
+}
+
+void ANLManager::statistics_to_json(const std::string& filename) const
+{
+  boost::property_tree::ptree pt = statistics_to_property_tree();
+  write_json(filename.c_str(), pt);
+}
+
 ANLStatus ANLManager::routine_define()
 {
   return routine_modfn(&BasicModule::mod_define, "define", modules_);
@@ -591,7 +787,19 @@ ANLStatus ANLManager::routine_pre_initialize()
 
 ANLStatus ANLManager::routine_initialize()
 {
-  return routine_modfn(&BasicModule::mod_initialize, "initialize", modules_);
+  for (BasicModule* mod: modules_) {
+    mod->unfreeze_shared_state();
+  }
+
+  const ANLStatus status = routine_modfn(&BasicModule::mod_initialize, "initialize", modules_);
+
+  // the shared state published by the master modules becomes read-only
+  // before the clones are initialized.
+  for (BasicModule* mod: modules_) {
+    mod->freeze_shared_state();
+  }
+
+  return status;
 }
 
 ANLStatus ANLManager::routine_begin_run()
@@ -609,10 +817,134 @@ ANLStatus ANLManager::routine_finalize()
   return routine_modfn(&BasicModule::mod_finalize, "finalize", modules_);
 }
 
+void ANLManager::begin_analysis_loop()
+{
+  // the loop indices of a new loop may be the same as those of the values
+  // left by the previous loop.
+  event_data_bus_->invalidate();
+  event_arena_->reset_peak_usage();
+}
+
+std::size_t ANLManager::event_arena_peak_usage() const
+{
+  return event_arena_->peak_usage();
+}
+
+ANLStatus ANLManager::process_analysis_with_progress_report()
+{
+  loop_begin_ = 0;
+  loop_end_ = number_of_loops();
+  begin_analysis_loop();
+
+  if (!resume_file_.empty()) {
+    const std::string filename = resume_file_;
+    resume_file_.clear();
+    restore_checkpoint(filename);
+    progress_.reset(number_of_progress_counters(),
+                    (number_of_loops() < 0) ? number_of_loops() : (number_of_loops() - loop_begin_));
+  }
+
+  const double interval = progress_report_interval();
+  if (interval <= 0.0) {
+    return process_analysis_with_checkpoints();
+  }
+
+  ANLStatus status = AS_OK;
+  progress_.start(interval);
+  try {
+    status = process_analysis_with_checkpoints();
+  }
+  catch (...) {
+    progress_.stop();
+    throw;
+  }
+  progress_.stop();
+  return status;
+}
+
+ANLStatus ANLManager::process_analysis_with_checkpoints()
+{
+  const long int num_events = number_of_loops();
+  if (checkpoint_period_ == 0 || checkpoint_file_.empty()) {
+    loop_end_ = num_events;
+    return process_analysis();
+  }
+
+  if (!is_checkpoint_supported()) {
+    std::cout << "ANLManager: checkpoints are not supported in this mode.\n" << std::endl;
+    loop_end_ = num_events;
+    return process_analysis();
+  }
+
+  // the loop is processed range by range; all the chains are synchronized
+  // at the end of each range, where a checkpoint is written.
+  while (num_events < 0 || loop_begin_ < num_events) {
+    loop_end_ = loop_begin_ + checkpoint_period_;
+    if (num_events >= 0 && loop_end_ > num_events) {
+      loop_end_ = num_events;
+    }
+
+    const ANLStatus status = process_analysis();
+    if (status != AS_OK) {
+      return status;
+    }
+    if (requested_ == ANLRequest::quit) {
+      break;
+    }
+
+    loop_begin_ = loop_end_;
+    save_checkpoint();
+  }
+  return AS_OK;
+}
+
+void ANLManager::save_checkpoint()
+{
+  CheckpointWriter writer(checkpoint_file_);
+  writer.write(static_cast<int64_t>(loop_begin_));
+  writer.write(static_cast<int64_t>(number_of_loops()));
+  write_checkpoint_chains(writer);
+  writer.commit();
+}
+
+void ANLManager::restore_checkpoint(const std::string& filename)
+{
+  if (!is_checkpoint_supported()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Resume from checkpoint is not supported in this mode ===> %s") % filename).str()) );
+  }
+
+  CheckpointReader reader(filename);
+  const long int position = reader.read<int64_t>();
+  const long int num_events = reader.read<int64_t>();
+  if (num_events != number_of_loops()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Checkpoint was written for %d events, not %d ===> %s") % num_events % number_of_loops() % filename).str()) );
+  }
+  read_checkpoint_chains(reader);
+  loop_begin_ = position;
+
+  std::cout << "ANLManager: resumed from checkpoint " << filename
+            << " at event " << position << ".\n" << std::endl;
+}
+
+void ANLManager::write_checkpoint_chains(CheckpointWriter& writer)
+{
+  writer.write(static_cast<int32_t>(1));
+  writer.write_chain(modules_, counters_, *evs_manager_);
+}
+
+void ANLManager::read_checkpoint_chains(CheckpointReader& reader)
+{
+  const int num_chains = reader.read<int32_t>();
+  if (num_chains != 1) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Checkpoint has %d chains, but the manager has 1") % num_chains).str()) );
+  }
+  reader.read_chain(modules_, counters_, *evs_manager_);
+}
+
 void ANLManager::process_analysis_for_the_thread(std::promise<ANLStatus> status_promise)
 {
   try {
-    ANLStatus s = process_analysis();
+    ANLStatus s = process_analysis_with_progress_report();
     status_promise.set_value(s);
   }
   catch (...) {
@@ -682,24 +1014,52 @@ void ANLManager::interactive_session()
   }
 }
 
-ANLStatus process_one_event(long int i_event,
-                            const std::vector<BasicModule*>& modules,
-                            std::vector<LoopCounter>& counters,
-                            EvsManager& evs_manager)
+boost::property_tree::ptree module_counter_to_property_tree(const BasicModule& module,
+                                                            const LoopCounter& counter)
 {
-  evs_manager.reset_all_flags();
-  ANLStatus status = AS_OK;
-
-  for (BasicModule* mod: modules) {
-    mod->set_loop_index(i_event);
+  boost::property_tree::ptree pt;
+  pt.put("module_id", module.module_id());
+  pt.put("name", module.module_name());
+  pt.put("entry", counter.entry());
+  pt.put("ok", counter.ok());
+  pt.put("skip", counter.skip());
+  pt.put("error", counter.error());
+  pt.put("quit", counter.quit());
+  if (counter.timed() > 0) {
+    pt.put("timing.calls", counter.timed());
+    pt.put("timing.total_ns", counter.total_time());
+    pt.put("timing.mean_ns", counter.mean_time());
+    pt.put("timing.min_ns", counter.min_time());
+    pt.put("timing.max_ns", counter.max_time());
+    boost::property_tree::ptree pt_histogram;
+    for (long int c: counter.time_histogram()) {
+      boost::property_tree::ptree pt_bin;
+      pt_bin.put("", c);
+      pt_histogram.push_back(std::make_pair("", std::move(pt_bin)));
+    }
+    pt.add_child("timing.histogram_log2_ns", std::move(pt_histogram));
   }
+  return pt;
+}
 
-  const std::size_t NumberOfModules = modules.size();
-  for (std::size_t i_module=0; i_module<NumberOfModules; i_module++) {
+ANLStatus process_modules_in_range(long int i_event,
+                                   const std::vector<BasicModule*>& modules,
+                                   std::vector<LoopCounter>& counters,
+                                   std::size_t module_begin,
+                                   std::size_t module_end)
+{
+  ANLStatus status = AS_OK;
+
+  for (std::size_t i_module=module_begin; i_module<module_end; i_module++) {
     BasicModule* mod = modules[i_module];
 
     if (mod->is_on()) {
       counters[i_module].count_up_by_entry();
+#if ANLNEXT_MODULE_TIMING
+      const bool timing = counters[i_module].is_timing_enabled();
+      std::chrono::steady_clock::time_point time_start;
+      if (timing) { time_start = std::chrono::steady_clock::now(); }
+#endif
 
       try {
         status = mod->mod_analyze();
@@ -713,6 +1073,12 @@ ANLStatus process_one_event(long int i_event,
         throw;
       }
 
+#if ANLNEXT_MODULE_TIMING
+      if (timing) {
+        const auto time_spent = std::chrono::steady_clock::now() - time_start;
+        counters[i_module].count_up_time(std::chrono::duration_cast<std::chrono::nanoseconds>(time_spent).count());
+      }
+#endif
       counters[i_module].count_up_by_result(status);
       status = eliminate_normal_error_status(status);
 
@@ -722,10 +1088,51 @@ ANLStatus process_one_event(long int i_event,
     }
   }
 
+  return status;
+}
+
+ANLStatus process_one_event(long int i_event,
+                            const std::vector<BasicModule*>& modules,
+                            std::vector<LoopCounter>& counters,
+                            EvsManager& evs_manager)
+{
+  evs_manager.reset_all_flags();
+  rewind_event_arenas(modules, 0, modules.size());
+
+  for (BasicModule* mod: modules) {
+    mod->set_loop_index(i_event);
+  }
+
+  const ANLStatus status = process_modules_in_range(i_event, modules, counters, 0, modules.size());
+
   count_evs(status, evs_manager);
   return status;
 }
 
+ANLStatus process_one_event_head(long int i_event,
+                                 const std::vector<BasicModule*>& modules,
+                                 std::vector<LoopCounter>& counters,
+                                 EvsManager& evs_manager,
+                                 std::size_t tail_begin)
+{
+  evs_manager.reset_all_flags();
+  rewind_event_arenas(modules, 0, tail_begin);
+
+  for (BasicModule* mod: modules) {
+    mod->set_loop_index(i_event);
+  }
+
+  return process_modules_in_range(i_event, modules, counters, 0, tail_begin);
+}
+
+ANLStatus process_one_event_tail(long int i_event,
+                                 const std::vector<BasicModule*>& modules,
+                                 std::vector<LoopCounter>& counters,
+                                 std::size_t tail_begin)
+{
+  return process_modules_in_range(i_event, modules, counters, tail_begin, modules.size());
+}
+
 ANLStatus process_one_event(long int i_event,
                             const std::vector<BasicModule*>& modules,
                             std::vector<LoopCounter>& counters,
@@ -733,6 +1140,7 @@ ANLStatus process_one_event(long int i_event,
                             std::vector<std::unique_ptr<OrderKeeper>>& order_keepers)
 {
   evs_manager.reset_all_flags();
+  rewind_event_arenas(modules, 0, modules.size());
   ANLStatus status = AS_OK;
 
   for (BasicModule* mod: modules) {
@@ -747,6 +1155,11 @@ ANLStatus process_one_event(long int i_event,
 
     if (status == AS_OK && mod->is_on()) {
       counters[i_module].count_up_by_entry();
+#if ANLNEXT_MODULE_TIMING
+      const bool timing = counters[i_module].is_timing_enabled();
+      std::chrono::steady_clock::time_point time_start;
+      if (timing) { time_start = std::chrono::steady_clock::now(); }
+#endif
 
       try {
         status = mod->mod_analyze();
@@ -760,6 +1173,12 @@ ANLStatus process_one_event(long int i_event,
         throw;
       }
 
+#if ANLNEXT_MODULE_TIMING
+      if (timing) {
+        const auto time_spent = std::chrono::steady_clock::now() - time_start;
+        counters[i_module].count_up_time(std::chrono::duration_cast<std::chrono::nanoseconds>(time_spent).count());
+      }
+#endif
       counters[i_module].count_up_by_result(status);
       status = eliminate_normal_error_status(status);
     }
@@ -769,6 +1188,187 @@ ANLStatus process_one_event(long int i_event,
   return status;
 }
 
+void rewind_event_arenas(const std::vector<BasicModule*>& modules,
+                         std::size_t module_begin,
+                         std::size_t module_end)
+{
+  EventArena* last = nullptr;
+  for (std::size_t i_module=module_begin; i_module<module_end; i_module++) {
+    EventArena* arena = modules[i_module]->event_arena();
+    if (arena != last && arena != nullptr) {
+      arena->rewind();
+      last = arena;
+    }
+  }
+}
+
+std::size_t process_event_batch(long int first_index,
+                                long int num_events,
+                                const std::vector<BasicModule*>& modules,
+                                std::vector<LoopCounter>& counters,
+                                EvsManager& evs_manager,
+                                EventBatch& batch)
+{
+  const std::size_t n = num_events;
+  const std::size_t num_modules = modules.size();
+  batch.statuses.assign(n, AS_OK);
+  batch.results.assign(num_modules*n, EventBatch::Result());
+  rewind_event_arenas(modules, 0, num_modules);
+  evs_manager.reset_all_flags();
+  batch.evs_flags.resize(n);
+  for (std::size_t i=0; i<n; i++) {
+    evs_manager.save_flags(batch.evs_flags[i]);
+  }
+
+  // events from num_valid on are discarded, since an earlier event quits,
+  // fails, or has to be processed again before them.
+  std::size_t num_valid = n;
+  auto ends_batch = [](ANLStatus s) {
+    return (s == AS_QUIT || s == AS_QUIT_ALL || s == AS_REDO || is_critical_error(s));
+  };
+
+  std::size_t run_begin = 0;
+  while (run_begin < num_modules) {
+    const bool batch_run = modules[run_begin]->is_batch_analysis();
+    std::size_t run_end = run_begin + 1;
+    while (run_end < num_modules && modules[run_end]->is_batch_analysis() == batch_run) {
+      ++run_end;
+    }
+
+    if (batch_run) {
+      for (std::size_t i_module=run_begin; i_module<run_end; i_module++) {
+        BasicModule* mod = modules[i_module];
+        if (mod->is_off()) { continue; }
+
+        std::size_t num_entered = 0;
+        batch.module_statuses.assign(n, AS_SKIP);
+        for (std::size_t i=0; i<num_valid; i++) {
+          if (batch.statuses[i] == AS_OK) {
+            batch.module_statuses[i] = AS_OK;
+            ++num_entered;
+          }
+        }
+        if (num_entered == 0) { continue; }
+
+        for (BasicModule* m: modules) {
+          m->set_loop_index(first_index);
+        }
+
+#if ANLNEXT_MODULE_TIMING
+        const bool timing = counters[i_module].is_timing_enabled();
+        std::chrono::steady_clock::time_point time_start;
+        if (timing) { time_start = std::chrono::steady_clock::now(); }
+#endif
+
+        try {
+          mod->mod_analyze_batch(first_index, batch.module_statuses);
+        }
+        catch (ANLException& ex) {
+          ex << ErrorInfoOnLoopIndex(first_index);
+          ex << ErrorInfoOnMethod( mod->module_name() + "::mod_analyze_batch" );
+          ex << ErrorInfoOnModuleID( mod->module_id() );
+          ex << ErrorInfoOnModuleName( mod->module_name() );
+          ex << ErrorInfoOnChainID( mod->copy_id() );
+          throw;
+        }
+
+        int64_t time_per_event = -1;
+#if ANLNEXT_MODULE_TIMING
+        if (timing) {
+          const auto time_spent = std::chrono::steady_clock::now() - time_start;
+          time_per_event = std::chrono::duration_cast<std::chrono::nanoseconds>(time_spent).count() / num_entered;
+        }
+#endif
+
+        for (std::size_t i=0; i<num_valid; i++) {
+          if (batch.statuses[i] != AS_OK) { continue; }
+          EventBatch::Result& result = batch.results[i_module*n+i];
+          result.status = batch.module_statuses[i];
+          result.entered = true;
+          result.time = time_per_event;
+          batch.statuses[i] = eliminate_normal_error_status(result.status);
+          if (ends_batch(batch.statuses[i])) {
+            num_valid = i + 1;
+          }
+        }
+      }
+    }
+    else {
+      for (std::size_t i=0; i<num_valid; i++) {
+        if (batch.statuses[i] != AS_OK) { continue; }
+
+        const long int i_event = first_index + i;
+        for (BasicModule* m: modules) {
+          m->set_loop_index(i_event);
+        }
+        evs_manager.restore_flags(batch.evs_flags[i]);
+
+        for (std::size_t i_module=run_begin; i_module<run_end; i_module++) {
+          BasicModule* mod = modules[i_module];
+          if (mod->is_off()) { continue; }
+
+#if ANLNEXT_MODULE_TIMING
+          const bool timing = counters[i_module].is_timing_enabled();
+          std::chrono::steady_clock::time_point time_start;
+          if (timing) { time_start = std::chrono::steady_clock::now(); }
+#endif
+
+          ANLStatus status = AS_OK;
+          try {
+            status = mod->mod_analyze();
+          }
+          catch (ANLException& ex) {
+            ex << ErrorInfoOnLoopIndex(i_event);
+            ex << ErrorInfoOnMethod( mod->module_name() + "::mod_analyze" );
+            ex << ErrorInfoOnModuleID( mod->module_id() );
+            ex << ErrorInfoOnModuleName( mod->module_name() );
+            ex << ErrorInfoOnChainID( mod->copy_id() );
+            throw;
+          }
+
+          EventBatch::Result& result = batch.results[i_module*n+i];
+          result.status = status;
+          result.entered = true;
+#if ANLNEXT_MODULE_TIMING
+          if (timing) {
+            const auto time_spent = std::chrono::steady_clock::now() - time_start;
+            result.time = std::chrono::duration_cast<std::chrono::nanoseconds>(time_spent).count();
+          }
+#endif
+
+          batch.statuses[i] = eliminate_normal_error_status(status);
+          if (batch.statuses[i] != AS_OK) { break; }
+        }
+
+        evs_manager.save_flags(batch.evs_flags[i]);
+        if (ends_batch(batch.statuses[i])) {
+          num_valid = i + 1;
+          break;
+        }
+      }
+    }
+
+    run_begin = run_end;
+  }
+
+  // counting in the order of the events, as if they were processed one by one.
+  for (std::size_t i=0; i<num_valid; i++) {
+    for (std::size_t i_module=0; i_module<num_modules; i_module++) {
+      const EventBatch::Result& result = batch.results[i_module*n+i];
+      if (!result.entered) { continue; }
+      counters[i_module].count_up_by_entry();
+      if (result.time >= 0) {
+        counters[i_module].count_up_time(result.time);
+      }
+      counters[i_module].count_up_by_result(result.status);
+    }
+    evs_manager.restore_flags(batch.evs_flags[i]);
+    count_evs(batch.statuses[i], evs_manager);
+  }
+
+  return num_valid;
+}
+
 void count_evs(ANLStatus status, EvsManager& evs_manager)
 {
   if (status == AS_OK) {
@@ -20,6 +20,9 @@
 #include "ANLManagerMT.hh"
 
 #include <boost/format.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <thread>
 
@@ -30,13 +33,25 @@
 #include "ANLManager_impl.hh"
 #include "ClonedChainSet_impl.hh"
 #include "OrderKeeper.hh"
+#include "ParallelLogBuffer.hh"
+#include "Checkpoint.hh"
+#include "EventDataBus.hh"
+#include "EventArena.hh"
 
 namespace anlnext
 {
 
 ANLManagerMT::ANLManagerMT(int num_parallels)
   : num_parallels_(num_parallels),
-    loop_index_(-1)
+    chunk_size_(1),
+    adaptive_chunk_(false),
+    work_stealing_(false),
+    reorder_buffer_size_(0),
+    use_reorder_buffer_(false),
+    tail_begin_(0),
+    use_hybrid_mode_(false),
+    segment_begin_(0),
+    segment_end_(0)
 {
   set_print_parallel_modules();
 }
@@ -58,21 +73,99 @@ BasicModule* ANLManagerMT::access_to_module(int chain_ID, const std::string& mod
   return nullptr;
 }
 
+template <typename T>
+void ANLManagerMT::run_on_pinned_thread(int thread_index, T func)
+{
+  if (!affinity_.is_enabled()) {
+    func();
+    return;
+  }
+  // chains beyond the threads (extra chains of the buffer) share the CPUs.
+  worker_pool_.run_one(thread_index % worker_pool_.size(), func);
+}
+
+int ANLManagerMT::number_of_threads() const
+{
+  // in the reorder buffer mode, one more thread processes the tail.
+  // in the hybrid mode, two more threads process the head and the tail.
+  if (use_reorder_buffer_) {
+    return num_parallels_ + 1;
+  }
+  else if (use_hybrid_mode_) {
+    return num_parallels_ + 2;
+  }
+  return num_parallels_;
+}
+
+void ANLManagerMT::start_worker_pool()
+{
+  worker_pool_.start(number_of_threads(),
+                     [this](int i_thread) {
+                       if (affinity_.is_enabled()) {
+                         affinity_.pin_current_thread(i_thread);
+                       }
+                     });
+}
+
 void ANLManagerMT::clone_modules(int chain_ID)
 {
-  ClonedChainSet chain(chain_ID, *evs_manager_);
-  for (BasicModule* mod: modules_) {
-    chain.push(mod->clone());
+  ClonedChainSet chain(chain_ID, *evs_manager_, *event_data_bus_);
+  chain.set_module_offset(segment_begin_);
+  for (std::size_t i=0; i<modules_.size(); i++) {
+    if (segment_begin_ <= i && i < segment_end_) {
+      chain.push(modules_[i]->clone());
+    }
+    else {
+      chain.push_shared(modules_[i]);
+    }
   }
   chain.setup_module_access();
   cloned_chains_.push_back(std::move(chain));
 }
 
+void ANLManagerMT::setup_parallel_segment()
+{
+  use_hybrid_mode_ = false;
+  segment_begin_ = 0;
+  segment_end_ = modules_.size();
+  if (segment_first_module_id_.empty() && segment_last_module_id_.empty()) {
+    return;
+  }
+
+  const int first = module_index(segment_first_module_id_);
+  const int last = module_index(segment_last_module_id_);
+  if (first < 0 || last < 0 || first > last) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Invalid parallel segment ===> %s - %s") % segment_first_module_id_ % segment_last_module_id_).str()) );
+  }
+
+  for (int i=first; i<=last; i++) {
+    if (modules_[i]->is_order_sensitive()) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("Order-sensitive module must be out of the parallel segment ===> Module ID: %s") % modules_[i]->module_id()).str()) );
+    }
+  }
+
+  use_hybrid_mode_ = true;
+  segment_begin_ = first;
+  segment_end_ = last + 1;
+}
+
 void ANLManagerMT::duplicate_chains()
 {
+  setup_parallel_segment();
+
+  tail_begin_ = modules_.size();
+  for (std::size_t i=0; i<modules_.size(); i++) {
+    if (modules_[i]->is_order_sensitive()) {
+      tail_begin_ = i;
+      break;
+    }
+  }
+  use_reorder_buffer_ = (!use_hybrid_mode_ && reorder_buffer_size_ > 0 && tail_begin_ < modules_.size());
+
   order_keepers_.clear();
   for (BasicModule* mod: modules_) {
-    if (mod->is_order_sensitive()) {
+    // in the hybrid mode, order-sensitive modules run on the tail thread.
+    if (mod->is_order_sensitive() && !use_reorder_buffer_ && !use_hybrid_mode_) {
       order_keepers_.emplace_back(new OrderKeeper);
     }
     else {
@@ -80,14 +173,39 @@ void ANLManagerMT::duplicate_chains()
     }
   }
 
-  for (int i=1; i<num_parallels_; i++) {
-    clone_modules(i);
+  int num_chains = num_parallels_;
+  if (use_reorder_buffer_) {
+    num_chains += reorder_buffer_size_;
+  }
+  else if (use_hybrid_mode_) {
+    num_chains += (reorder_buffer_size_ > 0) ? reorder_buffer_size_ : num_parallels_;
+  }
+  affinity_.setup();
+  start_worker_pool();
+  for (int i=1; i<num_chains; i++) {
+    // the cloned modules are allocated by the thread of the chain.
+    run_on_pinned_thread(i, [this, i]() { clone_modules(i); });
   }
   std::cout << "\n"
             << "<Module chain duplication>\n"
-            << (num_parallels_-1) << " chains have been duplicated. => "
-            << "Total: " << num_parallels_ << " chains.\n"
-            << std::endl;
+            << (num_chains-1) << " chains have been duplicated. => "
+            << "Total: " << num_chains << " chains.\n";
+  if (affinity_.is_enabled()) {
+    std::cout << "Threads are pinned to CPUs (" << affinity_.policy_name() << "):";
+    for (int i=0; i<num_chains; i++) {
+      std::cout << ' ' << affinity_.cpu(i);
+    }
+    std::cout << '\n';
+  }
+  if (use_reorder_buffer_) {
+    std::cout << "Modules from " << modules_[tail_begin_]->module_id()
+              << " are processed in order through the reorder buffer.\n";
+  }
+  if (use_hybrid_mode_) {
+    std::cout << "Modules from " << segment_first_module_id_ << " to " << segment_last_module_id_
+              << " are processed in parallel (hybrid mode).\n";
+  }
+  std::cout << std::endl;
 
   automatic_switch_for_singletons();
 }
@@ -135,22 +253,89 @@ void ANLManagerMT::print_results()
 void ANLManagerMT::reset_counters()
 {
   ANLManager::reset_counters();
+  master_counters_.clear();
+  master_evs_.reset();
   for (auto& chain: cloned_chains_) {
     chain.reset_counters();
   }
 }
 
+void ANLManagerMT::apply_module_timing()
+{
+  ANLManager::apply_module_timing();
+  for (auto& chain: cloned_chains_) {
+    chain.set_counter_timing(module_timing());
+  }
+}
+
+template <typename T>
+ANLStatus ANLManagerMT::routine_modfn_for_clones(T func, const std::string& func_id)
+{
+  if (!parallel_routines_) {
+    ANLStatus status = AS_OK;
+    for (auto& chain: cloned_chains_) {
+      run_on_pinned_thread(chain.chain_id(), [&status, &chain, func, &func_id]() {
+          status = routine_modfn(func,
+                                 boost::str(boost::format("%s:%d")%func_id%chain.chain_id()),
+                                 chain.modules_reference());
+        });
+      if (status != AS_OK) { break; }
+    }
+    return status;
+  }
+
+  // every chain runs the routine on its worker thread. The log of each
+  // chain is buffered and printed in the order of the chains. As in the
+  // serial run, the chains after the first chain that fails are skipped.
+  const std::size_t num_chains = cloned_chains_.size();
+  std::vector<ANLStatus> status_vector(num_chains, AS_OK);
+  std::vector<std::exception_ptr> exception_vector(num_chains);
+  std::atomic<std::size_t> first_failure(num_chains);
+  {
+    ParallelLogBuffer log(std::cout, num_chains);
+    const int num_workers = worker_pool_.size();
+    worker_pool_.run_all([&](int i_worker) {
+        for (std::size_t i=0; i<num_chains; i++) {
+          ClonedChainSet& chain = cloned_chains_[i];
+          if (chain.chain_id() % num_workers != i_worker) { continue; }
+          if (i > first_failure.load()) { continue; }
+          log.attach(i);
+          try {
+            status_vector[i] = routine_modfn(func,
+                                             boost::str(boost::format("%s:%d")%func_id%chain.chain_id()),
+                                             chain.modules_reference());
+          }
+          catch (...) {
+            exception_vector[i] = std::current_exception();
+          }
+          log.detach();
+
+          if (exception_vector[i] || status_vector[i] != AS_OK) {
+            std::size_t failure = first_failure.load();
+            while (i < failure && !first_failure.compare_exchange_weak(failure, i)) {}
+          }
+        }
+      });
+  }
+
+  // the result is that of the first chain that failed.
+  for (std::size_t i=0; i<num_chains; i++) {
+    if (exception_vector[i]) {
+      std::rethrow_exception(exception_vector[i]);
+    }
+    if (status_vector[i] != AS_OK) {
+      return status_vector[i];
+    }
+  }
+  return AS_OK;
+}
+
 ANLStatus ANLManagerMT::routine_initialize()
 {
   ANLStatus status = AS_OK;
   status = ANLManager::routine_initialize();
   if (status == AS_OK) {
-    for (auto& chain: cloned_chains_) {
-      status = routine_modfn(&BasicModule::mod_initialize,
-                             boost::str(boost::format("initialize:%d")%chain.chain_id()),
-                             chain.modules_reference());
-      if (status != AS_OK) { break; }
-    }
+    status = routine_modfn_for_clones(&BasicModule::mod_initialize, "initialize");
   }
   return status;
 }
@@ -160,12 +345,7 @@ ANLStatus ANLManagerMT::routine_begin_run()
   ANLStatus status = AS_OK;
   status = ANLManager::routine_begin_run();
   if (status == AS_OK) {
-    for (auto& chain: cloned_chains_) {
-      status = routine_modfn(&BasicModule::mod_begin_run,
-                             boost::str(boost::format("begin_run:%d")%chain.chain_id()),
-                             chain.modules_reference());
-      if (status != AS_OK) { break; }
-    }
+    status = routine_modfn_for_clones(&BasicModule::mod_begin_run, "begin_run");
   }
   return status;
 }
@@ -175,12 +355,7 @@ ANLStatus ANLManagerMT::routine_end_run()
   ANLStatus status = AS_OK;
   status = ANLManager::routine_end_run();
   if (status == AS_OK) {
-    for (auto& chain: cloned_chains_) {
-      status = routine_modfn(&BasicModule::mod_end_run,
-                             boost::str(boost::format("end_run:%d")%chain.chain_id()),
-                             chain.modules_reference());
-      if (status != AS_OK) { break; }
-    }
+    status = routine_modfn_for_clones(&BasicModule::mod_end_run, "end_run");
   }
   return status;
 }
@@ -190,59 +365,184 @@ ANLStatus ANLManagerMT::routine_finalize()
   ANLStatus status = AS_OK;
   status = ANLManager::routine_finalize();
   if (status == AS_OK) {
-    for (auto& chain: cloned_chains_) {
-      status = routine_modfn(&BasicModule::mod_finalize,
-                             boost::str(boost::format("finalize:%d")%chain.chain_id()),
-                             chain.modules_reference());
-      if (status != AS_OK) { break; }
-    }
+    status = routine_modfn_for_clones(&BasicModule::mod_finalize, "finalize");
   }
   return status;
 }
 
-long int ANLManagerMT::event_index_to_process()
+template <typename T>
+ANLStatus ANLManagerMT::process_with_chain(int chain_index, T func)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  const long int N = number_of_loops();
-  ++loop_index_;
-  if (loop_index_ >= N) {
-    return N;
+  if (chain_index == 0) {
+    return func(modules_, counters_, *evs_manager_);
   }
+  return cloned_chains_[chain_index-1].process(func);
+}
+
+bool ANLManagerMT::event_range_to_process(int i_thread, LoopIndexRange& range)
+{
   if (requested_ == ANLRequest::quit) {
-    return N;
+    return false;
+  }
+  return dispatcher_.take(i_thread, range);
+}
+
+long int ANLManagerMT::loop_index_span() const
+{
+  if (use_hybrid_mode_ || use_reorder_buffer_) {
+    return number_of_chains();
+  }
+  if (is_order_sensitive_chain()) {
+    return num_parallels_;
   }
+  if (work_stealing_ && number_of_loops() >= 0) {
+    // the chains start from the blocks divided in advance.
+    return -1;
+  }
+  const long int chunk_size = is_batch_mode() ? std::max(chunk_size_, batch_size()) : chunk_size_;
+  return chunk_size * num_parallels_;
+}
 
-  return loop_index_;
+bool ANLManagerMT::is_order_sensitive_chain() const
+{
+  return std::any_of(std::begin(order_keepers_), std::end(order_keepers_),
+                     [](const std::unique_ptr<OrderKeeper>& k){ return (k != nullptr); });
 }
 
-void ANLManagerMT::decrement_event_index()
+void ANLManagerMT::begin_analysis_loop()
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  --loop_index_;
+  ANLManager::begin_analysis_loop();
+  quit_chains_.assign(number_of_chains(), 0);
+  for (ClonedChainSet& chain: cloned_chains_) {
+    chain.event_data_bus().invalidate();
+    chain.event_arena().reset_peak_usage();
+  }
+  if (tail_arena_) {
+    tail_arena_->reset_peak_usage();
+  }
+
+  // the master chain restarts from its own counts, since the counts of the
+  // cloned chains, which are kept since Initialize(), are added again at the
+  // reduction.
+  if (master_counters_.size() == counters_.size()) {
+    counters_ = master_counters_;
+    apply_module_timing();
+  }
+  if (master_evs_) {
+    *evs_manager_ = *master_evs_;
+  }
 }
 
 ANLStatus ANLManagerMT::process_analysis()
 {
-  std::vector<std::future<ANLStatus>> status_future_vector;
-  std::vector<std::thread> analysis_threads(num_parallels_);
-  for (int i=0; i<num_parallels_; i++) {
-    std::promise<ANLStatus> status_promise;
-    status_future_vector.push_back(status_promise.get_future());
-    analysis_threads[i] = std::thread(std::bind(&ANLManagerMT::process_analysis_in_each_thread, this, i, std::placeholders::_1),
-                                      std::move(status_promise));
+  for (auto& keeper: order_keepers_) {
+    if (keeper) { keeper->reset(loop_begin()); }
+  }
+
+  if (use_hybrid_mode_) {
+    // only the head thread takes indices.
+    dispatcher_.reset(loop_end(), 1, 1, false, false, loop_begin());
+  }
+  else if (is_order_sensitive_chain() || use_reorder_buffer_) {
+    // an order-sensitive module waits for all the preceding indices,
+    // so that a chain must not hold a range of more than one index.
+    dispatcher_.reset(loop_end(), num_parallels_, 1, false, false, loop_begin());
+  }
+  else if (is_batch_mode()) {
+    // a range covers at least one batch.
+    const long int chunk_size = std::max(chunk_size_, batch_size());
+    dispatcher_.reset(loop_end(), num_parallels_, chunk_size, adaptive_chunk_, work_stealing_, loop_begin());
+  }
+  else {
+    dispatcher_.reset(loop_end(), num_parallels_, chunk_size_, adaptive_chunk_, work_stealing_, loop_begin());
   }
 
-  for (int i=0; i<num_parallels_; i++) {
-    analysis_threads[i].join();
+  const int num_threads = number_of_threads();
+  if (worker_pool_.size() != num_threads) {
+    start_worker_pool();
   }
 
-  std::vector<ANLStatus> status_vector(num_parallels_, AS_OK);
-  for (int i=0; i<num_parallels_; i++) {
-    status_vector[i] = status_future_vector[i].get();
+  if (use_reorder_buffer_) {
+    reorder_buffer_.reset(number_of_chains(), num_parallels_, loop_begin());
+    // a chain that has quit in a previous range of the loop stays retired.
+    for (int i=0; i<number_of_chains(); i++) {
+      if (has_chain_quit(i)) {
+        reorder_buffer_.retire_free_chain(i);
+      }
+    }
+  }
+  else if (use_hybrid_mode_) {
+    reorder_buffer_.reset(number_of_chains(), num_parallels_ + 1, loop_begin());
+    segment_queue_.reset();
+
+    // the EVS flags are passed among the chains in the order of the keys.
+    for (ClonedChainSet& chain: cloned_chains_) {
+      chain.define_missing_evs(*evs_manager_);
+    }
+    head_evs_.reset(new EvsManager(*evs_manager_));
+    tail_evs_.reset(new EvsManager(*evs_manager_));
+    for (EvsManager* evs: {head_evs_.get(), tail_evs_.get()}) {
+      evs->reset_all_flags();
+      evs->reset_all_counts();
+    }
+    for (std::size_t i=0; i<segment_begin_; i++) {
+      modules_[i]->set_evs_manager(head_evs_.get());
+    }
+    // the tail modules may run while the chain of the event is reused by
+    // the head, so that they have their own arena.
+    if (!tail_arena_) {
+      tail_arena_.reset(new EventArena);
+    }
+    for (std::size_t i=segment_end_; i<modules_.size(); i++) {
+      modules_[i]->set_evs_manager(tail_evs_.get());
+      modules_[i]->set_event_arena(tail_arena_.get());
+    }
+  }
+
+  partial_reducer_.reset(number_of_chains(), partial_reduction_period_, partial_reduction_interval_);
+  if (is_partial_reduction_enabled()) {
+    partial_reducer_.start([this](int chain_index) { return merge_deltas(chain_index); });
+  }
+
+  std::vector<ANLStatus> status_vector;
+  std::exception_ptr thread_exception;
+  try {
+    status_vector = run_analysis_threads(num_threads);
+
+    // a range given back by a chain that quits is left if the other chains
+    // have already finished; the chains that have not quit process it.
+    while (!use_reorder_buffer_ && !use_hybrid_mode_
+           && requested_ != ANLRequest::quit
+           && !all_chains_quit()
+           && dispatcher_.has_returned_ranges()) {
+      const std::vector<ANLStatus> v = run_analysis_threads(num_threads);
+      status_vector.insert(std::end(status_vector), std::begin(v), std::end(v));
+    }
+
+    if (all_chains_quit()) {
+      requested_ = ANLRequest::quit;
+    }
+  }
+  catch (...) {
+    thread_exception = std::current_exception();
+  }
+
+  const ANLStatus reduction_status = partial_reducer_.stop();
+
+  if (use_hybrid_mode_) {
+    for (BasicModule* mod: modules_) {
+      mod->set_evs_manager(evs_manager_.get());
+      mod->set_event_data_bus(event_data_bus_.get());
+      mod->set_event_arena(event_arena_.get());
+    }
+  }
+
+  if (thread_exception) {
+    std::rethrow_exception(thread_exception);
   }
 
   ANLStatus status = AS_OK;
+  status_vector.push_back(reduction_status);
   for (ANLStatus s: status_vector) {
     if (s == ANLStatus::critical_error_to_finalize) {
       status = s;
@@ -264,27 +564,87 @@ ANLStatus ANLManagerMT::process_analysis()
     }
   }
 
+  if (is_normal_error(reduction_status)) {
+    std::cout << "\n"
+              << "ANLManagerMT: partial reduction was stopped by " << reduction_status << ".\n"
+              << "The deltas detached but not merged may be missing from the results.\n"
+              << std::endl;
+  }
+
   return status;
 }
 
+std::vector<ANLStatus> ANLManagerMT::run_analysis_threads(int num_threads)
+{
+  std::vector<std::promise<ANLStatus>> status_promise_vector(num_threads);
+  std::vector<std::future<ANLStatus>> status_future_vector;
+  for (int i=0; i<num_threads; i++) {
+    status_future_vector.push_back(status_promise_vector[i].get_future());
+  }
+
+  worker_pool_.run_all([this, &status_promise_vector](int i_thread) {
+      process_analysis_in_each_thread(i_thread, std::move(status_promise_vector[i_thread]));
+    });
+
+  std::vector<ANLStatus> status_vector(num_threads, AS_OK);
+  for (int i=0; i<num_threads; i++) {
+    status_vector[i] = status_future_vector[i].get();
+  }
+  return status_vector;
+}
+
+bool ANLManagerMT::all_chains_quit() const
+{
+  return (!quit_chains_.empty()
+          && std::all_of(std::begin(quit_chains_), std::end(quit_chains_),
+                         [](char q) { return (q != 0); }));
+}
+
 void ANLManagerMT::process_analysis_in_each_thread(int i_thread, std::promise<ANLStatus> status_promise)
 {
   try {
     ANLStatus status = AS_OK;
-    if (i_thread==0) {
-      status = process_analysis_impl(modules_, counters_, *evs_manager_);
+    if (use_hybrid_mode_) {
+      if (i_thread == num_parallels_) {
+        status = process_hybrid_head_impl(0);
+        segment_queue_.close();
+        reorder_buffer_.close_producer();
+      }
+      else if (i_thread == num_parallels_+1) {
+        status = process_hybrid_tail_impl();
+      }
+      else {
+        status = process_hybrid_segment_impl();
+        reorder_buffer_.close_producer();
+      }
+    }
+    else if (use_reorder_buffer_) {
+      if (i_thread == num_parallels_) {
+        status = process_analysis_tail_impl();
+      }
+      else {
+        status = process_analysis_head_impl(i_thread);
+        reorder_buffer_.close_producer();
+      }
     }
     else {
-      using std::placeholders::_1;
-      using std::placeholders::_2;
-      using std::placeholders::_3;
-      status = cloned_chains_[i_thread-1].process(std::bind(&ANLManagerMT::process_analysis_impl, this, _1, _2, _3));
+      auto impl = is_batch_mode() ? &ANLManagerMT::process_analysis_in_batches_impl : &ANLManagerMT::process_analysis_impl;
+      if (i_thread==0) {
+        status = (this->*impl)(i_thread, modules_, counters_, *evs_manager_);
+      }
+      else {
+        using std::placeholders::_1;
+        using std::placeholders::_2;
+        using std::placeholders::_3;
+        status = cloned_chains_[i_thread-1].process(std::bind(impl, this, i_thread, _1, _2, _3));
+      }
     }
     status_promise.set_value(status);
   }
   catch (...) {
     if (exception_propagation()) {
       requested_ = ANLRequest::quit;
+      abort_buffers();
       status_promise.set_exception(std::current_exception());
     }
     else {
@@ -293,23 +653,21 @@ void ANLManagerMT::process_analysis_in_each_thread(int i_thread, std::promise<AN
   }
 }
 
-ANLStatus ANLManagerMT::process_analysis_impl(const std::vector<BasicModule*>& modules,
+ANLStatus ANLManagerMT::process_analysis_impl(int i_thread,
+                                              const std::vector<BasicModule*>& modules,
                                               std::vector<LoopCounter>& counters,
                                               EvsManager& evs_manager)
 {
   ANLStatus status = AS_OK;
-
-  const long int period_disp = display_period();
-  const long int num_events = number_of_loops();
+  if (has_chain_quit(i_thread)) {
+    return status;
+  }
 
   try {
+    LoopIndexRange range;
     while (true) {
-      const long int i_event = event_index_to_process();
-      if (i_event == num_events) { break; }
-
-      if (period_disp != 0 && i_event%period_disp == 0) {
-        print_event_index(i_event);
-      }
+      if (range.empty() && !event_range_to_process(i_thread, range)) { break; }
+      const long int i_event = range.begin;
 
       status = process_one_event(i_event, modules, counters, evs_manager, order_keepers_);
 
@@ -319,6 +677,11 @@ ANLStatus ANLManagerMT::process_analysis_impl(const std::vector<BasicModule*>& m
       }
 
       if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        // the rest of the range is left to the other chains, and this
+        // chain does not take indices in the following ranges.
+        set_chain_quit(i_thread);
+        range.begin = i_event + 1;
+        dispatcher_.give_back(i_thread, range);
         break;
       }
 
@@ -341,7 +704,22 @@ ANLStatus ANLManagerMT::process_analysis_impl(const std::vector<BasicModule*>& m
         ;
       }
       else if (status==ANLStatus::redo) {
-        decrement_event_index();
+        continue;
+      }
+
+      progress_.count_up(i_thread);
+      range.begin = i_event + 1;
+
+      if (partial_reducer_.is_active()) {
+        partial_reducer_.count_up(i_event);
+        if (partial_reducer_.is_requested(i_thread)) {
+          const ANLStatus detach_status = detach_deltas(modules);
+          if (is_critical_error(detach_status)) {
+            requested_ = ANLRequest::quit;
+            return detach_status;
+          }
+          partial_reducer_.submit(i_thread);
+        }
       }
     }
 
@@ -350,31 +728,603 @@ ANLStatus ANLManagerMT::process_analysis_impl(const std::vector<BasicModule*>& m
     }
   }
   catch (ANLException& ex) {
-    if (const ANLException::Treatment* t = boost::get_error_info<ExceptionTreatment>(ex)) {
-      if (*t == ANLException::Treatment::rethrow) {
-        throw;
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+bool ANLManagerMT::is_batch_mode() const
+{
+  return (batch_size() > 1
+          && !use_reorder_buffer_
+          && !use_hybrid_mode_
+          && !is_order_sensitive_chain());
+}
+
+ANLStatus ANLManagerMT::process_analysis_in_batches_impl(int i_thread,
+                                                         const std::vector<BasicModule*>& modules,
+                                                         std::vector<LoopCounter>& counters,
+                                                         EvsManager& evs_manager)
+{
+  ANLStatus status = AS_OK;
+  EventBatch batch;
+  if (has_chain_quit(i_thread)) {
+    return status;
+  }
+
+  try {
+    LoopIndexRange range;
+    while (true) {
+      if (range.empty() && !event_range_to_process(i_thread, range)) { break; }
+      const long int first_index = range.begin;
+      const long int num_events = std::min(batch_size(), range.end - range.begin);
+
+      const std::size_t num_processed
+        = process_event_batch(first_index, num_events, modules, counters, evs_manager, batch);
+
+      // a batch that ends with an event to redo is continued after the event.
+      const long int next_index = (batch.statuses[num_processed-1] == ANLStatus::redo)
+        ? (first_index + num_processed)
+        : (first_index + num_events);
+      for (std::size_t i=0; i<num_processed; i++) {
+        const long int i_event = first_index + i;
+        status = batch.statuses[i];
+        while (status == ANLStatus::redo) {
+          status = process_one_event(i_event, modules, counters, evs_manager);
+        }
+
+        if (is_critical_error(status)) {
+          requested_ = ANLRequest::quit;
+          return status;
+        }
+
+        if (status == AS_QUIT || status == AS_QUIT_ALL) {
+          break;
+        }
+
+        progress_.count_up(i_thread);
+
+        if (partial_reducer_.is_active()) {
+          partial_reducer_.count_up(i_event);
+          if (partial_reducer_.is_requested(i_thread)) {
+            const ANLStatus detach_status = detach_deltas(modules);
+            if (is_critical_error(detach_status)) {
+              requested_ = ANLRequest::quit;
+              return detach_status;
+            }
+            partial_reducer_.submit(i_thread);
+          }
+        }
+      }
+
+      if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        // the events of the batch after the quit are discarded as in the
+        // single-thread mode, since the preceding modules have processed
+        // them; the rest of the range is left to the other chains.
+        set_chain_quit(i_thread);
+        range.begin = next_index;
+        dispatcher_.give_back(i_thread, range);
+        break;
       }
-      else if (*t == ANLException::Treatment::finalize) {
+
+      range.begin = next_index;
+
+      if (requested_ != ANLRequest::none) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const long int i_event = range.begin - 1;
+        if (requested_ == ANLRequest::quit) {
+          break;
+        }
+        else if (requested_ == ANLRequest::show_event_index) {
+          print_event_index(i_event);
+        }
+        else if (requested_ == ANLRequest::show_evs_summary) {
+          print_event_index(i_event);
+          evs_manager_->print_summary();
+        }
+        requested_ = ANLRequest::none;
+      }
+    }
+
+    if (status == AS_QUIT_ALL) {
+      requested_ = ANLRequest::quit;
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+bool ANLManagerMT::is_partial_reduction_enabled() const
+{
+  if (partial_reduction_period_ == 0 && partial_reduction_interval_ == 0.0) {
+    return false;
+  }
+  if (use_reorder_buffer_ || use_hybrid_mode_) {
+    return false;
+  }
+  for (const BasicModule* mod: modules_) {
+    if (mod->is_partial_reduction() && mod->is_on()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ANLStatus ANLManagerMT::detach_deltas(const std::vector<BasicModule*>& modules)
+{
+  for (BasicModule* mod: modules) {
+    if (!mod->is_partial_reduction() || mod->is_off()) { continue; }
+    const ANLStatus status = mod->mod_detach_delta();
+    if (is_critical_error(status)) {
+      return status;
+    }
+  }
+  return AS_OK;
+}
+
+ANLStatus ANLManagerMT::merge_deltas(int chain_index)
+{
+  // called by the reducer thread while the chains are running.
+  const std::vector<BasicModule*>& chain_modules
+    = (chain_index == 0) ? modules_ : cloned_chains_[chain_index-1].modules_reference();
+
+  try {
+    for (std::size_t i=0; i<modules_.size(); i++) {
+      BasicModule* mod = modules_[i];
+      if (!mod->is_partial_reduction() || mod->is_off()) { continue; }
+      const ANLStatus status = mod->mod_merge_delta(chain_modules[i]);
+      if (is_critical_error(status)) {
         requested_ = ANLRequest::quit;
-        print_exception(ex);
-        return ANLStatus::critical_error_to_finalize_from_exception;
+        return status;
+      }
+      if (is_normal_error(status)) {
+        // the reducer stops the partial reduction; the loop continues.
+        std::cout << "\n"
+                  << "Error in partial reduction\n"
+                  << mod->module_name() << "::mod_merge_delta returned " << status
+                  << " for chain " << chain_index << std::endl;
+        return status;
       }
-      else if (*t == ANLException::Treatment::terminate) {
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+EventDataBus& ANLManagerMT::chain_event_data_bus(int chain_index)
+{
+  if (chain_index == 0) {
+    return *event_data_bus_;
+  }
+  return cloned_chains_[chain_index-1].event_data_bus();
+}
+
+EventArena& ANLManagerMT::chain_event_arena(int chain_index)
+{
+  if (chain_index == 0) {
+    return *event_arena_;
+  }
+  return cloned_chains_[chain_index-1].event_arena();
+}
+
+std::size_t ANLManagerMT::event_arena_peak_usage() const
+{
+  std::size_t peak = ANLManager::event_arena_peak_usage();
+  for (const ClonedChainSet& chain: cloned_chains_) {
+    peak = std::max(peak, chain.event_arena().peak_usage());
+  }
+  if (tail_arena_) {
+    peak = std::max(peak, tail_arena_->peak_usage());
+  }
+  return peak;
+}
+
+ANLStatus ANLManagerMT::process_analysis_head_impl(int i_thread)
+{
+  ANLStatus status = AS_OK;
+
+  try {
+    while (true) {
+      const int chain_index = reorder_buffer_.acquire_chain();
+      if (chain_index < 0) { break; }
+
+      LoopIndexRange range;
+      if (!event_range_to_process(i_thread, range)) {
+        reorder_buffer_.release_chain(chain_index);
+        break;
+      }
+      const long int i_event = range.begin;
+
+      status = process_with_chain(chain_index,
+                                  [this, i_event](const std::vector<BasicModule*>& modules,
+                                                  std::vector<LoopCounter>& counters,
+                                                  EvsManager& evs_manager) {
+                                    ANLStatus s = AS_OK;
+                                    do {
+                                      s = process_one_event_head(i_event, modules, counters, evs_manager, tail_begin_);
+                                    } while (s == ANLStatus::redo);
+                                    return s;
+                                  });
+
+      ReorderBuffer::Entry entry;
+      entry.index = i_event;
+      entry.chain = chain_index;
+      entry.status = status;
+      reorder_buffer_.push(entry);
+
+      if (is_critical_error(status)) {
         requested_ = ANLRequest::quit;
-        print_exception(ex);
-        return ANLStatus::critical_error_to_terminate_from_exception;
+        return status;
       }
-      else if (*t == ANLException::Treatment::hard_terminate) {
-        print_exception(ex);
-        std::terminate();
+
+      if (status == AS_QUIT) {
+        break;
+      }
+
+      if (status == AS_QUIT_ALL) {
+        requested_ = ANLRequest::quit;
+        break;
+      }
+
+      if (requested_ != ANLRequest::none) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (requested_ == ANLRequest::quit) {
+          break;
+        }
+        else if (requested_ == ANLRequest::show_event_index) {
+          print_event_index(i_event);
+        }
+        else if (requested_ == ANLRequest::show_evs_summary) {
+          print_event_index(i_event);
+          evs_manager_->print_summary();
+        }
+        requested_ = ANLRequest::none;
       }
     }
-    throw;
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
   }
 
   return AS_OK;
 }
 
+ANLStatus ANLManagerMT::process_analysis_tail_impl()
+{
+  try {
+    ReorderBuffer::Entry entry;
+    while (reorder_buffer_.pop_next(entry)) {
+      const long int i_event = entry.index;
+      const ANLStatus head_status = entry.status;
+      const ANLStatus status
+        = process_with_chain(entry.chain,
+                             [this, i_event, head_status](const std::vector<BasicModule*>& modules,
+                                                          std::vector<LoopCounter>& counters,
+                                                          EvsManager& evs_manager) {
+                               ANLStatus s = head_status;
+                               if (s == AS_OK) {
+                                 s = process_one_event_tail(i_event, modules, counters, tail_begin_);
+                               }
+                               // redo of the event is done by this thread
+                               // so that the order is kept.
+                               while (s == ANLStatus::redo) {
+                                 s = process_one_event_head(i_event, modules, counters, evs_manager, tail_begin_);
+                                 if (s == AS_OK) {
+                                   s = process_one_event_tail(i_event, modules, counters, tail_begin_);
+                                 }
+                               }
+                               count_evs(s, evs_manager);
+                               return s;
+                             });
+
+      if (is_critical_error(status)) {
+        requested_ = ANLRequest::quit;
+        abort_buffers();
+        return status;
+      }
+
+      progress_.count_up(entry.chain);
+
+      if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        if (status == AS_QUIT_ALL) {
+          requested_ = ANLRequest::quit;
+        }
+        set_chain_quit(entry.chain);
+        reorder_buffer_.retire_chain(entry.chain);
+      }
+      else {
+        reorder_buffer_.release_chain(entry.chain);
+      }
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+ANLStatus ANLManagerMT::process_hybrid_head_impl(int i_thread)
+{
+  ANLStatus status = AS_OK;
+
+  EvsManager& head_evs = *head_evs_;
+  std::vector<uint64_t> evs_flags;
+
+  try {
+    while (true) {
+      const int chain_index = reorder_buffer_.acquire_chain();
+      if (chain_index < 0) { break; }
+
+      LoopIndexRange range;
+      if (!event_range_to_process(i_thread, range)) {
+        reorder_buffer_.release_chain(chain_index);
+        break;
+      }
+      const long int i_event = range.begin;
+
+      // the head modules publish the event data into the bus of the chain
+      // that processes the segment, and allocate from its arena.
+      EventDataBus* event_data_bus = &chain_event_data_bus(chain_index);
+      EventArena* event_arena = &chain_event_arena(chain_index);
+      for (std::size_t i_module=0; i_module<segment_begin_; i_module++) {
+        modules_[i_module]->set_loop_index(i_event);
+        modules_[i_module]->set_event_data_bus(event_data_bus);
+        modules_[i_module]->set_event_arena(event_arena);
+      }
+
+      do {
+        event_arena->rewind();
+        head_evs.reset_all_flags();
+        status = process_modules_in_range(i_event, modules_, counters_, 0, segment_begin_);
+      } while (status == ANLStatus::redo);
+
+      if (is_critical_error(status)) {
+        requested_ = ANLRequest::quit;
+        abort_buffers();
+        return status;
+      }
+
+      head_evs.save_flags(evs_flags);
+      process_with_chain(chain_index,
+                         [&evs_flags](const std::vector<BasicModule*>&,
+                                      std::vector<LoopCounter>&,
+                                      EvsManager& evs_manager) {
+                           evs_manager.restore_flags(evs_flags);
+                           return AS_OK;
+                         });
+
+      ReorderBuffer::Entry entry;
+      entry.index = i_event;
+      entry.chain = chain_index;
+      entry.status = status;
+      if (status == AS_OK) {
+        segment_queue_.push(entry);
+      }
+      else {
+        reorder_buffer_.push(entry);
+      }
+
+      if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        requested_ = ANLRequest::quit;
+        break;
+      }
+
+      if (requested_ != ANLRequest::none) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (requested_ == ANLRequest::quit) {
+          break;
+        }
+        else if (requested_ == ANLRequest::show_event_index) {
+          print_event_index(i_event);
+        }
+        else if (requested_ == ANLRequest::show_evs_summary) {
+          print_event_index(i_event);
+          evs_manager_->print_summary();
+        }
+        requested_ = ANLRequest::none;
+      }
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+ANLStatus ANLManagerMT::process_hybrid_segment_impl()
+{
+  ANLStatus status = AS_OK;
+  std::vector<uint64_t> evs_flags;
+
+  try {
+    ReorderBuffer::Entry entry;
+    while (segment_queue_.pop(entry)) {
+      const long int i_event = entry.index;
+      // the master chain holds all the modules, while a cloned chain holds
+      // the segment only.
+      const std::size_t offset = (entry.chain == 0) ? 0 : segment_begin_;
+      const std::size_t module_begin = segment_begin_ - offset;
+      const std::size_t module_end = segment_end_ - offset;
+
+      status = process_with_chain(entry.chain,
+                                  [i_event, module_begin, module_end, &evs_flags]
+                                  (const std::vector<BasicModule*>& modules,
+                                   std::vector<LoopCounter>& counters,
+                                   EvsManager& evs_manager) {
+                                    for (std::size_t i_module=module_begin; i_module<module_end; i_module++) {
+                                      modules[i_module]->set_loop_index(i_event);
+                                    }
+                                    evs_manager.save_flags(evs_flags);
+                                    ANLStatus s = AS_OK;
+                                    do {
+                                      evs_manager.restore_flags(evs_flags);
+                                      s = process_modules_in_range(i_event, modules, counters, module_begin, module_end);
+                                    } while (s == ANLStatus::redo);
+                                    return s;
+                                  });
+
+      if (is_critical_error(status)) {
+        requested_ = ANLRequest::quit;
+        abort_buffers();
+        return status;
+      }
+
+      entry.status = status;
+      reorder_buffer_.push(entry);
+
+      if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        requested_ = ANLRequest::quit;
+      }
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+ANLStatus ANLManagerMT::process_hybrid_tail_impl()
+{
+  EvsManager& tail_evs = *tail_evs_;
+  std::vector<uint64_t> evs_flags;
+  bool quit = false;
+  // the chain is kept until the tail modules read its event data.
+  const bool use_event_data = (event_data_bus_->number_of_slots() > 0);
+
+  try {
+    ReorderBuffer::Entry entry;
+    while (reorder_buffer_.pop_next(entry)) {
+      const long int i_event = entry.index;
+      process_with_chain(entry.chain,
+                         [&evs_flags](const std::vector<BasicModule*>&,
+                                      std::vector<LoopCounter>&,
+                                      EvsManager& evs_manager) {
+                           evs_manager.save_flags(evs_flags);
+                           return AS_OK;
+                         });
+      if (!use_event_data || quit) {
+        reorder_buffer_.release_chain(entry.chain);
+      }
+
+      if (quit) {
+        // events following the quit are discarded.
+        continue;
+      }
+
+      ANLStatus status = entry.status;
+      if (status == AS_OK) {
+        EventDataBus* event_data_bus = &chain_event_data_bus(entry.chain);
+        for (std::size_t i_module=segment_end_; i_module<modules_.size(); i_module++) {
+          modules_[i_module]->set_loop_index(i_event);
+          modules_[i_module]->set_event_data_bus(event_data_bus);
+        }
+        do {
+          tail_arena_->rewind();
+          tail_evs.restore_flags(evs_flags);
+          status = process_modules_in_range(i_event, modules_, counters_, segment_end_, modules_.size());
+        } while (status == ANLStatus::redo);
+      }
+      else {
+        tail_evs.restore_flags(evs_flags);
+      }
+
+      if (use_event_data) {
+        reorder_buffer_.release_chain(entry.chain);
+      }
+
+      if (is_critical_error(status)) {
+        requested_ = ANLRequest::quit;
+        abort_buffers();
+        return status;
+      }
+
+      count_evs(status, tail_evs);
+      progress_.count_up(entry.chain);
+
+      if (status == AS_QUIT || status == AS_QUIT_ALL) {
+        requested_ = ANLRequest::quit;
+        quit = true;
+      }
+    }
+  }
+  catch (ANLException& ex) {
+    return treat_exception_in_analysis(ex);
+  }
+
+  return AS_OK;
+}
+
+ANLStatus ANLManagerMT::treat_exception_in_analysis(ANLException& ex)
+{
+  if (const ANLException::Treatment* t = boost::get_error_info<ExceptionTreatment>(ex)) {
+    if (*t == ANLException::Treatment::rethrow) {
+      throw;
+    }
+    else if (*t == ANLException::Treatment::finalize) {
+      requested_ = ANLRequest::quit;
+      abort_buffers();
+      print_exception(ex);
+      return ANLStatus::critical_error_to_finalize_from_exception;
+    }
+    else if (*t == ANLException::Treatment::terminate) {
+      requested_ = ANLRequest::quit;
+      abort_buffers();
+      print_exception(ex);
+      return ANLStatus::critical_error_to_terminate_from_exception;
+    }
+    else if (*t == ANLException::Treatment::hard_terminate) {
+      print_exception(ex);
+      std::terminate();
+    }
+  }
+  throw;
+}
+
+void ANLManagerMT::abort_buffers()
+{
+  reorder_buffer_.abort();
+  segment_queue_.abort();
+}
+
+void ANLManagerMT::write_checkpoint_chains(CheckpointWriter& writer)
+{
+  writer.write(static_cast<int32_t>(number_of_chains()));
+  for (int i=0; i<number_of_chains(); i++) {
+    process_with_chain(i, [&writer](const std::vector<BasicModule*>& modules,
+                                    std::vector<LoopCounter>& counters,
+                                    EvsManager& evs_manager) {
+                         writer.write_chain(modules, counters, evs_manager);
+                         return AS_OK;
+                       });
+  }
+}
+
+void ANLManagerMT::read_checkpoint_chains(CheckpointReader& reader)
+{
+  const int num_chains = reader.read<int32_t>();
+  if (num_chains != number_of_chains()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Checkpoint has %d chains, but the manager has %d") % num_chains % number_of_chains()).str()) );
+  }
+  for (int i=0; i<number_of_chains(); i++) {
+    process_with_chain(i, [&reader](const std::vector<BasicModule*>& modules,
+                                    std::vector<LoopCounter>& counters,
+                                    EvsManager& evs_manager) {
+                         reader.read_chain(modules, counters, evs_manager);
+                         return AS_OK;
+                       });
+  }
+}
+
 ANLStatus ANLManagerMT::reduce_modules()
 {
   ANLStatus status = AS_OK;
@@ -382,8 +1332,21 @@ ANLStatus ANLManagerMT::reduce_modules()
     BasicModule* mod = modules_[i_module];
     std::list<BasicModule*> module_list;
     for (const ClonedChainSet& chain: cloned_chains_) {
-      module_list.push_back(chain.modules_reference()[i_module]);
+      const std::size_t offset = chain.module_offset();
+      if (offset <= i_module && i_module < offset + chain.modules_reference().size()) {
+        module_list.push_back(chain.modules_reference()[i_module-offset]);
+      }
+    }
+
+    if (mod->is_associative_merge() && module_list.size() > 1) {
+      const std::vector<BasicModule*> clones(module_list.begin(), module_list.end());
+      status = reduce_clones_in_tree(clones);
+      if (status != AS_OK) {
+        break;
+      }
+      module_list.assign(1, clones.front());
     }
+
     status = mod->mod_reduce(module_list);
     if (status != AS_OK) {
       break;
@@ -392,14 +1355,100 @@ ANLStatus ANLManagerMT::reduce_modules()
   return status;
 }
 
+ANLStatus ANLManagerMT::reduce_clones_in_tree(const std::vector<BasicModule*>& clones)
+{
+  // pairwise reduction in log2(N) rounds: at stride s, clones[k+s] is merged
+  // into clones[k] for k = 0, 2s, 4s, ...; the pairs of a round run
+  // concurrently on the workers. clones[0] holds the result at the end.
+  const std::size_t num_clones = clones.size();
+  const int num_workers = worker_pool_.size();
+  for (std::size_t stride=1; stride<num_clones; stride*=2) {
+    std::vector<std::size_t> receivers;
+    for (std::size_t k=0; k+stride<num_clones; k+=2*stride) {
+      receivers.push_back(k);
+    }
+
+    const std::size_t num_pairs = receivers.size();
+    std::vector<ANLStatus> status_vector(num_pairs, AS_OK);
+    std::vector<std::exception_ptr> exception_vector(num_pairs);
+    auto merge_pair = [&](std::size_t i_pair) {
+      const std::size_t k = receivers[i_pair];
+      try {
+        status_vector[i_pair] = clones[k]->mod_merge(clones[k+stride]);
+      }
+      catch (...) {
+        exception_vector[i_pair] = std::current_exception();
+      }
+    };
+
+    if (num_workers > 1 && num_pairs > 1) {
+      worker_pool_.run_all([&](int i_worker) {
+          for (std::size_t i=i_worker; i<num_pairs; i+=num_workers) {
+            merge_pair(i);
+          }
+        });
+    }
+    else {
+      for (std::size_t i=0; i<num_pairs; i++) {
+        merge_pair(i);
+      }
+    }
+
+    for (std::size_t i=0; i<num_pairs; i++) {
+      if (exception_vector[i]) {
+        std::rethrow_exception(exception_vector[i]);
+      }
+      if (status_vector[i] != AS_OK) {
+        return status_vector[i];
+      }
+    }
+  }
+  return AS_OK;
+}
+
 void ANLManagerMT::reduce_statistics()
 {
+  master_counters_ = counters_;
+  master_evs_.reset(new EvsManager(*evs_manager_));
+
   for (const ClonedChainSet& chain: cloned_chains_) {
-    for (std::size_t i=0; i<modules_.size(); i++) {
-      counters_[i] += chain.get_counter(i);
+    const std::size_t offset = chain.module_offset();
+    for (std::size_t i=0; i<chain.modules_reference().size(); i++) {
+      counters_[offset+i] += chain.get_counter(i);
     }
     evs_manager_->merge(chain.get_evs());
   }
+
+  // in the hybrid mode, the EVS flags are counted by the tail thread.
+  if (tail_evs_) {
+    evs_manager_->merge(*tail_evs_);
+  }
+  head_evs_.reset();
+  tail_evs_.reset();
+}
+
+void ANLManagerMT::print_summary()
+{
+  ANLManager::print_summary();
+
+  if (number_of_merged_deltas() > 0) {
+    std::cout << "<Partial reduction>\n"
+              << "  " << number_of_merged_deltas() << " deltas of the chains merged during the loop\n"
+              << std::endl;
+  }
+
+  if (dispatcher_.is_work_stealing()) {
+    std::cout << "<Work stealing>\n"
+              << "   chain  |     steals     | stolen indices \n"
+              << "----------------------------------------------\n";
+    for (int i=0; i<num_parallels_; i++) {
+      std::cout << boost::format("    %4d  | %14d | %14d\n")
+        % i
+        % dispatcher_.number_of_steals(i)
+        % dispatcher_.number_of_stolen_indices(i);
+    }
+    std::cout << std::endl;
+  }
 }
 
 boost::property_tree::ptree ANLManagerMT::parameters_to_property_tree() const
@@ -415,4 +1464,35 @@ boost::property_tree::ptree ANLManagerMT::parameters_to_property_tree() const
   return pt;
 }
 
+boost::property_tree::ptree ANLManagerMT::statistics_to_property_tree() const
+{
+  boost::property_tree::ptree pt = ANLManager::statistics_to_property_tree();
+  boost::property_tree::ptree pt_chains;
+  if (master_counters_.size() == modules_.size()) {
+    boost::property_tree::ptree pt_chain;
+    pt_chain.put("chain_id", 0);
+    pt_chain.put("event_arena_peak_usage", event_arena_->peak_usage());
+    boost::property_tree::ptree pt_modules;
+    for (std::size_t i=0; i<modules_.size(); i++) {
+      pt_modules.push_back(std::make_pair("", module_counter_to_property_tree(*modules_[i], master_counters_[i])));
+    }
+    pt_chain.add_child("module_list", std::move(pt_modules));
+    pt_chains.push_back(std::make_pair("", std::move(pt_chain)));
+  }
+  for (const ClonedChainSet& chain: cloned_chains_) {
+    boost::property_tree::ptree pt_chain;
+    pt_chain.put("chain_id", chain.chain_id());
+    pt_chain.put("event_arena_peak_usage", chain.event_arena().peak_usage());
+    boost::property_tree::ptree pt_modules;
+    const std::vector<BasicModule*>& modules = chain.modules_reference();
+    for (std::size_t i=0; i<modules.size(); i++) {
+      pt_modules.push_back(std::make_pair("", module_counter_to_property_tree(*modules[i], chain.get_counter(i))));
+    }
+    pt_chain.add_child("module_list", std::move(pt_modules));
+    pt_chains.push_back(std::make_pair("", std::move(pt_chain)));
+  }
+  pt.add_child("statistics.chain_list", std::move(pt_chains));
+  return pt;
+}
+
 } /* namespace anlnext*/
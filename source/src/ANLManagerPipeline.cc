@@ -0,0 +1,340 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "ANLManagerPipeline.hh"
+
+#include <boost/format.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+#include "BasicModule.hh"
+#include "EvsManager.hh"
+#include "EventArena.hh"
+#include "ANLException.hh"
+
+namespace anlnext
+{
+
+ANLManagerPipeline::ANLManagerPipeline()
+  : buffer_size_(64),
+    quit_index_(0)
+{
+}
+
+ANLManagerPipeline::~ANLManagerPipeline() = default;
+
+void ANLManagerPipeline::define_stage_boundary(const std::string& module_id)
+{
+  if (module_index(module_id) < 0) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Module is not found in the chain ===> Module ID: %s") % module_id).str()) );
+  }
+  stage_boundaries_.push_back(module_id);
+}
+
+void ANLManagerPipeline::setup_stages()
+{
+  const std::size_t num_modules = modules_.size();
+  std::vector<std::size_t> boundaries;
+  if (stage_boundaries_.empty()) {
+    for (std::size_t i=0; i<num_modules; i++) {
+      boundaries.push_back(i);
+    }
+  }
+  else {
+    boundaries.push_back(0);
+    for (const std::string& module_id: stage_boundaries_) {
+      const int index = module_index(module_id);
+      if (index < 0) {
+        BOOST_THROW_EXCEPTION( ANLException((boost::format("Module is not found in the chain ===> Module ID: %s") % module_id).str()) );
+      }
+      boundaries.push_back(index);
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+  }
+
+  stage_begin_ = boundaries;
+  stage_begin_.push_back(num_modules);
+  const int num_stages = number_of_stages();
+
+  buffers_.clear();
+  for (int i=0; i<num_stages-1; i++) {
+    buffers_.emplace_back(new SPSCRingBuffer<PipelineEvent>(buffer_size_));
+  }
+
+  stage_evs_.clear();
+  stage_arenas_.clear();
+  for (int i=0; i<num_stages; i++) {
+    stage_evs_.emplace_back(new EvsManager(*evs_manager_));
+    stage_evs_[i]->reset_all_flags();
+    stage_evs_[i]->reset_all_counts();
+    stage_arenas_.emplace_back(new EventArena);
+    for (std::size_t i_module=stage_begin_[i]; i_module<stage_begin_[i+1]; i_module++) {
+      modules_[i_module]->set_evs_manager(stage_evs_[i].get());
+      modules_[i_module]->set_event_arena(stage_arenas_[i].get());
+    }
+  }
+
+  quit_index_ = std::numeric_limits<long int>::max();
+}
+
+ANLStatus ANLManagerPipeline::process_analysis()
+{
+  if (modules_.empty()) {
+    return AS_OK;
+  }
+
+  setup_stages();
+  const int num_stages = number_of_stages();
+
+  std::vector<std::future<ANLStatus>> status_future_vector;
+  std::vector<std::thread> stage_threads(num_stages);
+  for (int i=0; i<num_stages; i++) {
+    std::promise<ANLStatus> status_promise;
+    status_future_vector.push_back(status_promise.get_future());
+    stage_threads[i] = std::thread(std::bind(&ANLManagerPipeline::process_stage, this, i, std::placeholders::_1),
+                                   std::move(status_promise));
+  }
+
+  for (int i=0; i<num_stages; i++) {
+    stage_threads[i].join();
+  }
+
+  for (BasicModule* mod: modules_) {
+    mod->set_evs_manager(evs_manager_.get());
+    mod->set_event_arena(event_arena_.get());
+  }
+
+  std::vector<ANLStatus> status_vector(num_stages, AS_OK);
+  for (int i=0; i<num_stages; i++) {
+    status_vector[i] = status_future_vector[i].get();
+  }
+
+  const ANLStatus priority[] = {
+    ANLStatus::critical_error_to_finalize,
+    ANLStatus::critical_error_to_finalize_from_exception,
+    ANLStatus::critical_error_to_terminate,
+    ANLStatus::critical_error_to_terminate_from_exception,
+  };
+  ANLStatus status = AS_OK;
+  for (ANLStatus p: priority) {
+    if (std::find(status_vector.begin(), status_vector.end(), p) != status_vector.end()) {
+      status = p;
+    }
+  }
+  return status;
+}
+
+void ANLManagerPipeline::process_stage(int i_stage, std::promise<ANLStatus> status_promise)
+{
+  try {
+    const ANLStatus status = process_stage_impl(i_stage);
+    status_promise.set_value(status);
+  }
+  catch (...) {
+    abort_pipeline();
+    if (exception_propagation()) {
+      status_promise.set_exception(std::current_exception());
+    }
+    else {
+      throw;
+    }
+  }
+}
+
+ANLStatus ANLManagerPipeline::process_stage_impl(int i_stage)
+{
+  const int num_stages = number_of_stages();
+  const bool first_stage = (i_stage == 0);
+  const bool last_stage = (i_stage == num_stages-1);
+  const std::size_t module_begin = stage_begin_[i_stage];
+  const std::size_t module_end = stage_begin_[i_stage+1];
+  SPSCRingBuffer<PipelineEvent>* input = first_stage ? nullptr : buffers_[i_stage-1].get();
+  SPSCRingBuffer<PipelineEvent>* output = last_stage ? nullptr : buffers_[i_stage].get();
+  EvsManager& evs_manager = *stage_evs_[i_stage];
+  EventArena& event_arena = *stage_arenas_[i_stage];
+
+  const long int num_events = number_of_loops();
+
+  ANLStatus status = AS_OK;
+  PipelineEvent event;
+  long int next_index = 0;
+
+  try {
+    while (true) {
+      long int i_event = 0;
+      if (first_stage) {
+        if (next_index == num_events || next_index > quit_index_) { break; }
+        i_event = next_index++;
+      }
+      else {
+        if (!input->pop(event)) { break; }
+        i_event = event.index;
+        if (i_event > quit_index_) {
+          // discarded since a later stage has quit at a preceding event.
+          continue;
+        }
+      }
+
+      if (first_stage || event.status == AS_OK) {
+        for (std::size_t i_module=module_begin; i_module<module_end; i_module++) {
+          modules_[i_module]->set_loop_index(i_event);
+        }
+
+        do {
+          event_arena.rewind();
+          if (first_stage) {
+            evs_manager.reset_all_flags();
+          }
+          else {
+            evs_manager.restore_flags(event.evs_flags);
+          }
+          status = process_modules_in_range(i_event, modules_, counters_, module_begin, module_end);
+        } while (status == ANLStatus::redo);
+
+        if (is_critical_error(status)) {
+          abort_pipeline();
+          return status;
+        }
+
+        if (status == AS_QUIT || status == AS_QUIT_ALL) {
+          request_quit_from(i_event);
+        }
+      }
+      else {
+        // the event has been finished by an earlier stage.
+        evs_manager.restore_flags(event.evs_flags);
+        status = event.status;
+      }
+
+      if (last_stage) {
+        count_evs(status, evs_manager);
+        progress_.count_up(0);
+      }
+      else {
+        // every event goes through to the last stage, which counts the
+        // EVS flags in the order of loop indices.
+        event.index = i_event;
+        event.status = status;
+        evs_manager.save_flags(event.evs_flags);
+        if (!output->push(event)) { break; }
+      }
+
+      if (first_stage && requested_ != ANLRequest::none) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (requested_ == ANLRequest::quit) {
+          break;
+        }
+        else if (requested_ == ANLRequest::show_event_index) {
+          print_event_index(i_event);
+        }
+        else if (requested_ == ANLRequest::show_evs_summary) {
+          print_event_index(i_event);
+          evs_manager_->print_summary();
+        }
+        requested_ = ANLRequest::none;
+      }
+    }
+  }
+  catch (ANLException& ex) {
+    if (const ANLException::Treatment* t = boost::get_error_info<ExceptionTreatment>(ex)) {
+      if (*t == ANLException::Treatment::rethrow) {
+        throw;
+      }
+      else if (*t == ANLException::Treatment::finalize) {
+        abort_pipeline();
+        print_exception(ex);
+        return ANLStatus::critical_error_to_finalize_from_exception;
+      }
+      else if (*t == ANLException::Treatment::terminate) {
+        abort_pipeline();
+        print_exception(ex);
+        return ANLStatus::critical_error_to_terminate_from_exception;
+      }
+      else if (*t == ANLException::Treatment::hard_terminate) {
+        print_exception(ex);
+        std::terminate();
+      }
+    }
+    throw;
+  }
+
+  if (output) {
+    output->close();
+  }
+
+  return AS_OK;
+}
+
+void ANLManagerPipeline::request_quit_from(long int i_event)
+{
+  long int current = quit_index_.load();
+  while (i_event < current && !quit_index_.compare_exchange_weak(current, i_event)) {
+    ;
+  }
+}
+
+void ANLManagerPipeline::abort_pipeline()
+{
+  requested_ = ANLRequest::quit;
+  for (auto& buffer: buffers_) {
+    buffer->abort();
+  }
+}
+
+void ANLManagerPipeline::reduce_statistics()
+{
+  if (!stage_evs_.empty()) {
+    evs_manager_->merge(*stage_evs_.back());
+  }
+  stage_evs_.clear();
+}
+
+std::size_t ANLManagerPipeline::event_arena_peak_usage() const
+{
+  std::size_t peak = ANLManager::event_arena_peak_usage();
+  for (const auto& arena: stage_arenas_) {
+    peak = std::max(peak, arena->peak_usage());
+  }
+  return peak;
+}
+
+void ANLManagerPipeline::print_summary()
+{
+  ANLManager::print_summary();
+
+  const int num_stages = number_of_stages();
+  if (num_stages > 0) {
+    std::cout << "<Pipeline stages>\n"
+              << "   stage  |  modules \n"
+              << "----------------------------------------------\n";
+    for (int i=0; i<num_stages; i++) {
+      std::cout << boost::format("    %4d  |  ") % i;
+      for (std::size_t i_module=stage_begin_[i]; i_module<stage_begin_[i+1]; i_module++) {
+        std::cout << modules_[i_module]->module_id() << ' ';
+      }
+      std::cout << '\n';
+    }
+    std::cout << std::endl;
+  }
+}
+
+} /* namespace anlnext */
@@ -30,15 +30,21 @@ namespace anlnext
 
 BasicModule::BasicModule()
   : order_sensitive_(false),
+    associative_merge_(false),
+    partial_reduction_(false),
+    batch_analysis_(false),
     module_ID_(""),
     access_permission_(ModuleAccess::Permission::full_access),
     module_description_(""),
     module_on_(true),
     evs_manager_(nullptr),
+    event_data_bus_(nullptr),
+    event_arena_(nullptr),
     module_access_(nullptr),
     current_parameter_(nullptr),
     current_value_element_(nullptr),
     loop_index_(-1),
+    loop_index_span_(1),
     copy_ID_(0),
     last_copy_(0),
     singleton_(false),
@@ -46,27 +52,35 @@ BasicModule::BasicModule()
 {
   module_ID_method_ = &BasicModule::module_name;
   singleton_ptr_ = std::make_shared<BasicModule*>(this);
+  shared_state_ = std::make_shared<SharedState>();
 }
 
 BasicModule::~BasicModule() = default;
 
 BasicModule::BasicModule(const BasicModule& r)
   : order_sensitive_(r.order_sensitive_),
+    associative_merge_(r.associative_merge_),
+    partial_reduction_(r.partial_reduction_),
+    batch_analysis_(r.batch_analysis_),
     module_ID_(r.module_ID_),
     aliases_(r.aliases_),
     access_permission_(r.access_permission_),
     module_description_(r.module_description_),
     module_on_(r.module_on_),
     evs_manager_(nullptr),
+    event_data_bus_(nullptr),
+    event_arena_(nullptr),
     module_access_(nullptr),
     current_parameter_(nullptr),
     current_value_element_(nullptr),
     loop_index_(-1),
+    loop_index_span_(r.loop_index_span_),
     copy_ID_(r.last_copy_+1),
     last_copy_(0),
     singleton_(r.singleton_),
     singleton_copy_ID_(r.singleton_copy_ID_),
-    singleton_ptr_(r.singleton_ptr_)
+    singleton_ptr_(r.singleton_ptr_),
+    shared_state_(r.shared_state_)
 {
   if (module_ID_=="") {
     module_ID_method_ = &BasicModule::module_name;
@@ -105,6 +119,15 @@ void BasicModule::set_module_id(const std::string& module_id)
   module_ID_method_ = &BasicModule::get_module_id;
 }
 
+void BasicModule::mod_analyze_batch(long int first_index, std::vector<ANLStatus>& statuses)
+{
+  for (std::size_t i=0; i<statuses.size(); i++) {
+    if (statuses[i] != AS_OK) { continue; }
+    set_loop_index(first_index+i);
+    statuses[i] = mod_analyze();
+  }
+}
+
 ANLStatus BasicModule::mod_reduce(const std::list<BasicModule*>& parallel_modules)
 {
   ANLStatus status = AS_OK;
@@ -176,9 +199,9 @@ void BasicModule::ask_parameter(const std::string& name,
   (*it)->ask();
 }
 
-void BasicModule::define_evs(const std::string& key)
+EvsHandle BasicModule::define_evs(const std::string& key)
 {
-  evs_manager_->define(key);
+  return evs_manager_->define(key);
 }
 
 void BasicModule::undefine_evs(const std::string& key)
@@ -206,6 +229,11 @@ void BasicModule::reset_evs(const std::string& key)
   evs_manager_->reset(key);
 }
 
+EvsHandle BasicModule::evs_handle(const std::string& key) const
+{
+  return evs_manager_->handle(key);
+}
+
 boost::property_tree::ptree BasicModule::parameters_to_property_tree() const
 {
   boost::property_tree::ptree pt;
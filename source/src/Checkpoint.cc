@@ -0,0 +1,177 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "Checkpoint.hh"
+#include <cstdio>
+#include <sstream>
+#include <boost/format.hpp>
+#include "ANLException.hh"
+#include "BasicModule.hh"
+#include "EvsManager.hh"
+#include "LoopCounter.hh"
+
+namespace anlnext
+{
+
+namespace
+{
+
+const char CheckpointMagic[] = "ANLNEXT-CHECKPOINT";
+const uint32_t CheckpointVersion = 1;
+
+} /* anonymous namespace */
+
+CheckpointWriter::CheckpointWriter(const std::string& filename)
+  : filename_(filename),
+    temporary_filename_(filename+".tmp"),
+    stream_(temporary_filename_, std::ios::binary | std::ios::trunc)
+{
+  if (!stream_) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Cannot open checkpoint file ===> %s") % temporary_filename_).str()) );
+  }
+  stream_.write(CheckpointMagic, sizeof(CheckpointMagic));
+  write(CheckpointVersion);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  if (!committed_) {
+    stream_.close();
+    std::remove(temporary_filename_.c_str());
+  }
+}
+
+void CheckpointWriter::write_string(const std::string& s)
+{
+  write(static_cast<uint64_t>(s.size()));
+  stream_.write(s.data(), s.size());
+}
+
+void CheckpointWriter::write_chain(const std::vector<BasicModule*>& modules,
+                                   const std::vector<LoopCounter>& counters,
+                                   const EvsManager& evs_manager)
+{
+  write(static_cast<uint64_t>(modules.size()));
+  for (std::size_t i=0; i<modules.size(); i++) {
+    BasicModule* mod = modules[i];
+    write_string(mod->module_id());
+    counters[i].save(stream_);
+
+    std::ostringstream state;
+    const ANLStatus status = mod->mod_save_state(state);
+    if (status != AS_OK) {
+      BOOST_THROW_EXCEPTION( ANLException(mod, (boost::format("Failed to save the state to checkpoint ===> %s") % filename_).str()) );
+    }
+    write_string(state.str());
+  }
+
+  const EvsMap evs_data = evs_manager.data();
+  write(static_cast<uint64_t>(evs_data.size()));
+  for (const auto& e: evs_data) {
+    write_string(e.first);
+    write(e.second.counts);
+    write(e.second.counts_ok);
+  }
+}
+
+void CheckpointWriter::commit()
+{
+  stream_.close();
+  if (stream_.fail()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Failed to write checkpoint file ===> %s") % temporary_filename_).str()) );
+  }
+  if (std::rename(temporary_filename_.c_str(), filename_.c_str()) != 0) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Failed to replace checkpoint file ===> %s") % filename_).str()) );
+  }
+  committed_ = true;
+}
+
+CheckpointReader::CheckpointReader(const std::string& filename)
+  : filename_(filename),
+    stream_(filename, std::ios::binary)
+{
+  if (!stream_) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Cannot open checkpoint file ===> %s") % filename_).str()) );
+  }
+
+  char magic[sizeof(CheckpointMagic)] = {};
+  stream_.read(magic, sizeof(magic));
+  if (!stream_ || std::string(magic) != CheckpointMagic) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Not a checkpoint file ===> %s") % filename_).str()) );
+  }
+  const uint32_t version = read<uint32_t>();
+  if (version != CheckpointVersion) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Unsupported checkpoint version %d ===> %s") % version % filename_).str()) );
+  }
+}
+
+CheckpointReader::~CheckpointReader() = default;
+
+std::string CheckpointReader::read_string()
+{
+  const uint64_t size = read<uint64_t>();
+  std::string s(size, '\0');
+  stream_.read(&s[0], size);
+  check_stream();
+  return s;
+}
+
+void CheckpointReader::read_chain(const std::vector<BasicModule*>& modules,
+                                  std::vector<LoopCounter>& counters,
+                                  EvsManager& evs_manager)
+{
+  const uint64_t num_modules = read<uint64_t>();
+  if (num_modules != modules.size()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Checkpoint has %d modules in a chain, but the chain has %d ===> %s") % num_modules % modules.size() % filename_).str()) );
+  }
+
+  for (std::size_t i=0; i<modules.size(); i++) {
+    BasicModule* mod = modules[i];
+    const std::string module_id = read_string();
+    if (module_id != mod->module_id()) {
+      BOOST_THROW_EXCEPTION( ANLException(mod, (boost::format("Checkpoint has module %s at this position ===> %s") % module_id % filename_).str()) );
+    }
+    counters[i].load(stream_);
+    check_stream();
+
+    std::istringstream state(read_string());
+    const ANLStatus status = mod->mod_restore_state(state);
+    if (status != AS_OK) {
+      BOOST_THROW_EXCEPTION( ANLException(mod, (boost::format("Failed to restore the state from checkpoint ===> %s") % filename_).str()) );
+    }
+  }
+
+  EvsMap evs_data;
+  const uint64_t num_evs = read<uint64_t>();
+  for (uint64_t i=0; i<num_evs; i++) {
+    EvsData& d = evs_data[read_string()];
+    d.counts = read<uint64_t>();
+    d.counts_ok = read<uint64_t>();
+  }
+  evs_manager.restore_counts(evs_data);
+}
+
+void CheckpointReader::check_stream()
+{
+  if (!stream_) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Checkpoint file is truncated ===> %s") % filename_).str()) );
+  }
+}
+
+} /* namespace anlnext */
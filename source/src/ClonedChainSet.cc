@@ -22,14 +22,19 @@
 
 #include "BasicModule.hh"
 #include "EvsManager.hh"
+#include "EventDataBus.hh"
+#include "EventArena.hh"
 #include "ModuleAccess.hh"
 
 namespace anlnext
 {
 
-ClonedChainSet::ClonedChainSet(int chain_id, const EvsManager& evs)
+ClonedChainSet::ClonedChainSet(int chain_id, const EvsManager& evs, const EventDataBus& event_data)
   : id_(chain_id),
+    module_offset_(0),
     evs_manager_(new EvsManager(evs)),
+    event_data_bus_(new EventDataBus(event_data)),
+    event_arena_(new EventArena),
     module_access_(new ModuleAccess)
 {
 }
@@ -40,27 +45,42 @@ void ClonedChainSet::push(std::unique_ptr<BasicModule>&& cloned_module)
 {
   std::unique_ptr<BasicModule> m = std::move(cloned_module);
   m->set_evs_manager(evs_manager_.get());
+  m->set_event_data_bus(event_data_bus_.get());
+  m->set_event_arena(event_arena_.get());
   m->set_module_access(module_access_.get());
   modules_ref_.push_back(m.get());
   modules_.push_back(std::move(m));
   counters_.push_back(LoopCounter());
 }
 
+void ClonedChainSet::push_shared(BasicModule* mod)
+{
+  shared_modules_.push_back(mod);
+}
+
 void ClonedChainSet::setup_module_access()
 {
+  for (BasicModule* mod: shared_modules_) {
+    register_to_module_access(mod);
+  }
   for (BasicModule* mod: modules_ref_) {
-    if (mod->access_permission() != ModuleAccess::Permission::privacy) {
-      const std::string module_ID = mod->module_id();
-      module_access_->register_module(module_ID,
-                                      mod,
-                                      ModuleAccess::ConflictOption::error);
+    register_to_module_access(mod);
+  }
+}
+
+void ClonedChainSet::register_to_module_access(BasicModule* mod)
+{
+  if (mod->access_permission() != ModuleAccess::Permission::privacy) {
+    const std::string module_ID = mod->module_id();
+    module_access_->register_module(module_ID,
+                                    mod,
+                                    ModuleAccess::ConflictOption::error);
     
-      for (const std::pair<std::string, ModuleAccess::ConflictOption>& alias: mod->get_aliases()) {
-        if (alias.first != module_ID) {
-          module_access_->register_module(alias.first,
-                                          mod,
-                                          alias.second);
-        }
+    for (const std::pair<std::string, ModuleAccess::ConflictOption>& alias: mod->get_aliases()) {
+      if (alias.first != module_ID) {
+        module_access_->register_module(alias.first,
+                                        mod,
+                                        alias.second);
       }
     }
   }
@@ -73,11 +93,23 @@ void ClonedChainSet::reset_counters()
   }
 }
 
+void ClonedChainSet::set_counter_timing(bool v)
+{
+  for (LoopCounter& c: counters_) {
+    c.set_timing_enabled(v);
+  }
+}
+
 BasicModule* ClonedChainSet::access_to_module(const std::string& module_ID)
 {
   return module_access_->get_module_NC(module_ID);
 }
 
+void ClonedChainSet::define_missing_evs(const EvsManager& evs)
+{
+  evs_manager_->define_missing(evs);
+}
+
 void ClonedChainSet::automatic_switch_for_singletons()
 {
   for (auto& mod: modules_) {
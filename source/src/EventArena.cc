@@ -0,0 +1,92 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "EventArena.hh"
+#include <algorithm>
+#include <new>
+#include "CacheAligned.hh"
+
+namespace anlnext
+{
+
+EventArena::EventArena(std::size_t block_size)
+{
+  blocks_.push_back(allocate_block(std::max<std::size_t>(block_size, CacheLineSize)));
+  current_ = blocks_[0].begin;
+  end_ = blocks_[0].end;
+}
+
+EventArena::~EventArena()
+{
+  for (const Block& block: blocks_) {
+    free_block(block);
+  }
+}
+
+std::size_t EventArena::capacity() const
+{
+  std::size_t size = 0;
+  for (const Block& block: blocks_) {
+    size += block.end - block.begin;
+  }
+  return size;
+}
+
+void* EventArena::allocate_from_next_block(std::size_t bytes, std::size_t alignment)
+{
+  // the rest of the current block is left unused.
+  used_ += end_ - current_;
+
+  const std::size_t required = bytes + alignment;
+  block_index_++;
+  if (block_index_ == blocks_.size() || static_cast<std::size_t>(blocks_[block_index_].end - blocks_[block_index_].begin) < required) {
+    const Block& last = blocks_[block_index_-1];
+    const std::size_t size = std::max<std::size_t>(2*(last.end - last.begin), required);
+    blocks_.insert(blocks_.begin()+block_index_, allocate_block(size));
+  }
+
+  current_ = blocks_[block_index_].begin;
+  end_ = blocks_[block_index_].end;
+  return do_allocate(bytes, alignment);
+}
+
+void EventArena::consolidate()
+{
+  const std::size_t size = capacity();
+  for (const Block& block: blocks_) {
+    free_block(block);
+  }
+  blocks_.clear();
+  blocks_.push_back(allocate_block(size));
+  block_index_ = 0;
+}
+
+EventArena::Block EventArena::allocate_block(std::size_t size)
+{
+  size = (size + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+  unsigned char* p = static_cast<unsigned char*>(::operator new(size, std::align_val_t(CacheLineSize)));
+  return Block{p, p+size};
+}
+
+void EventArena::free_block(const Block& block)
+{
+  ::operator delete(block.begin, std::align_val_t(CacheLineSize));
+}
+
+} /* namespace anlnext */
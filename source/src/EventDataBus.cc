@@ -0,0 +1,107 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "EventDataBus.hh"
+#include <algorithm>
+#include <boost/format.hpp>
+#include "ANLException.hh"
+
+namespace anlnext
+{
+
+EventDataBus::~EventDataBus()
+{
+  if (allocated_) {
+    for (const Slot& slot: slots_) {
+      slot.destroy(arena_.data() + slot.offset);
+    }
+  }
+}
+
+EventDataBus::EventDataBus(const EventDataBus& r)
+  : slots_(r.slots_),
+    handles_(r.handles_)
+{
+  if (r.allocated_) {
+    allocate();
+  }
+}
+
+int EventDataBus::define_slot(const std::string& key,
+                              std::type_index type,
+                              std::size_t size,
+                              std::size_t alignment,
+                              Construct construct,
+                              Destroy destroy)
+{
+  const auto it = handles_.find(key);
+  if (it != handles_.end()) {
+    if (slots_[it->second].type != type) {
+      BOOST_THROW_EXCEPTION( ANLException((boost::format("Event data is already defined with a different type ===> %s") % key).str()) );
+    }
+    return it->second;
+  }
+
+  if (allocated_) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Event data cannot be defined after allocation ===> %s") % key).str()) );
+  }
+
+  const int index = slots_.size();
+  slots_.push_back(Slot{key, type, size, alignment, 0, construct, destroy});
+  handles_.emplace(key, index);
+  return index;
+}
+
+int EventDataBus::find_slot(const std::string& key, std::type_index type) const
+{
+  const auto it = handles_.find(key);
+  if (it == handles_.end()) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Event data is not defined ===> %s") % key).str()) );
+  }
+  if (slots_[it->second].type != type) {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Event data has a different type ===> %s") % key).str()) );
+  }
+  return it->second;
+}
+
+void EventDataBus::allocate()
+{
+  if (allocated_) { return; }
+
+  std::size_t size = 0;
+  for (Slot& slot: slots_) {
+    size = (size + slot.alignment - 1) / slot.alignment * slot.alignment;
+    slot.offset = size;
+    size += slot.size;
+  }
+
+  arena_.assign(size, 0);
+  stamps_.assign(slots_.size(), unpublished);
+  for (const Slot& slot: slots_) {
+    slot.construct(arena_.data() + slot.offset);
+  }
+  allocated_ = true;
+}
+
+void EventDataBus::invalidate()
+{
+  std::fill(stamps_.begin(), stamps_.end(), unpublished);
+}
+
+} /* namespace anlnext */
@@ -19,46 +19,265 @@
 
 #include "EvsManager.hh"
 #include <iomanip>
+#include <algorithm>
+#include <mutex>
+#include <utility>
 
 namespace anlnext
 {
 
+namespace
+{
+
+/**
+ * process-wide table of the Evs keys.
+ */
+class EvsKeyRegistry
+{
+public:
+  EvsHandle intern(const std::string& key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = handles_.find(key);
+    if (it != handles_.end()) {
+      return it->second;
+    }
+    const EvsHandle handle = keys_.size();
+    keys_.push_back(key);
+    handles_.emplace(key, handle);
+    return handle;
+  }
+
+  std::string key_of(EvsHandle handle)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (handle < 0 || static_cast<std::size_t>(handle) >= keys_.size()) {
+      return std::string();
+    }
+    return keys_[handle];
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::string> keys_;
+  std::unordered_map<std::string, EvsHandle> handles_;
+};
+
+EvsKeyRegistry& evs_key_registry()
+{
+  static EvsKeyRegistry registry;
+  return registry;
+}
+
+} /* anonymous namespace */
+
+EvsHandle EvsManager::intern(const std::string& key)
+{
+  return evs_key_registry().intern(key);
+}
+
+std::string EvsManager::key_of(EvsHandle handle)
+{
+  return evs_key_registry().key_of(handle);
+}
+
+void EvsManager::SlicedCounter::resize(std::size_t num_words)
+{
+  planes_.resize(num_words*NumPlanes, 0);
+  num_added_.resize(num_words, 0);
+}
+
+void EvsManager::SlicedCounter::clear()
+{
+  std::fill(planes_.begin(), planes_.end(), 0);
+  std::fill(num_added_.begin(), num_added_.end(), 0);
+}
+
+void EvsManager::SlicedCounter::flush_word(std::size_t word, CacheAlignedVector<uint64_t>& counts)
+{
+  uint64_t* planes = &planes_[word*NumPlanes];
+  for (int k=0; k<NumPlanes; k++) {
+    uint64_t bits = planes[k];
+    while (bits) {
+      counts[word*64 + __builtin_ctzll(bits)] += (uint64_t(1) << k);
+      bits &= bits - 1;
+    }
+    planes[k] = 0;
+  }
+  num_added_[word] = 0;
+}
+
+void EvsManager::SlicedCounter::flush(CacheAlignedVector<uint64_t>& counts)
+{
+  for (std::size_t w=0; w<num_added_.size(); w++) {
+    if (num_added_[w] > 0) {
+      flush_word(w, counts);
+    }
+  }
+}
+
 EvsManager::~EvsManager() = default;
 
 void EvsManager::initialize()
 {
-  data_.clear();
+  flags_.clear();
+  dirty_.clear();
+  counter_.resize(0);
+  counter_ok_.resize(0);
+  defined_.clear();
+  counts_.clear();
+  counts_ok_.clear();
+  handles_.clear();
+}
+
+void EvsManager::expand(EvsHandle handle)
+{
+  const std::size_t n = static_cast<std::size_t>(handle) + 1;
+  if (n > capacity()) {
+    counts_.resize(n, 0);
+    counts_ok_.resize(n, 0);
+    const std::size_t num_words = (n+63)/64;
+    flags_.resize(num_words, 0);
+    dirty_.resize((num_words+63)/64, 0);
+    defined_.resize(num_words, 0);
+    counter_.resize(num_words);
+    counter_ok_.resize(num_words);
+  }
+}
+
+void EvsManager::define_handle(const std::string& key, EvsHandle handle)
+{
+  flush_counts();
+  expand(handle);
+  defined_[word_index(handle)] |= bit_mask(handle);
+  flags_[word_index(handle)] &= ~bit_mask(handle);
+  counts_[handle] = 0;
+  counts_ok_[handle] = 0;
+  handles_[key] = handle;
+}
+
+EvsHandle EvsManager::define(const std::string& key)
+{
+  const EvsHandle handle = intern(key);
+  define_handle(key, handle);
+  return handle;
+}
+
+void EvsManager::define_missing(const EvsManager& r)
+{
+  for (const auto& e: r.handles_) {
+    if (!is_defined(e.second)) {
+      define_handle(e.first, e.second);
+    }
+  }
+}
+
+void EvsManager::undefine(const std::string& key)
+{
+  const EvsHandle h = handle(key);
+  if (h == invalid_handle) {
+    return;
+  }
+  flush_counts();
+  defined_[word_index(h)] &= ~bit_mask(h);
+  flags_[word_index(h)] &= ~bit_mask(h);
+  counts_[h] = 0;
+  counts_ok_[h] = 0;
+  handles_.erase(key);
+}
+
+void EvsManager::report_undefined(EvsHandle handle) const
+{
+  std::cout << "EvsManager: Undefined key is given: " << key_of(handle)
+            << " (handle: " << handle << ")" << std::endl;
 }
 
 void EvsManager::reset_all_flags()
 {
-  for (auto& e: data_) {
-    e.second.flag = false;
+  const std::size_t n = dirty_.size();
+  for (std::size_t d=0; d<n; d++) {
+    uint64_t dirty = dirty_[d];
+    while (dirty) {
+      flags_[d*64 + __builtin_ctzll(dirty)] = 0;
+      dirty &= dirty - 1;
+    }
+    dirty_[d] = 0;
   }
 }
 
 void EvsManager::reset_all_counts()
 {
-  for (auto& e: data_) {
-    e.second.counts = 0;
+  std::fill(counts_.begin(), counts_.end(), 0);
+  std::fill(counts_ok_.begin(), counts_ok_.end(), 0);
+  counter_.clear();
+  counter_ok_.clear();
+}
+
+void EvsManager::restore_flags(const std::vector<uint64_t>& flags)
+{
+  std::fill(dirty_.begin(), dirty_.end(), 0);
+  const std::size_t n = std::min(flags.size(), flags_.size());
+  for (std::size_t i=0; i<n; i++) {
+    flags_[i] = flags[i] & defined_[i];
+    if (flags_[i]) {
+      dirty_[i >> 6] |= (uint64_t(1) << (i & 63));
+    }
   }
+  std::fill(flags_.begin()+n, flags_.end(), 0);
 }
 
-void EvsManager::count()
+void EvsManager::add_to_counter(SlicedCounter& counter, CacheAlignedVector<uint64_t>& counts)
 {
-  for (auto& e: data_) {
-    if (e.second.flag) {
-      ++(e.second.counts);
+  const std::size_t n = dirty_.size();
+  for (std::size_t d=0; d<n; d++) {
+    uint64_t dirty = dirty_[d];
+    while (dirty) {
+      const std::size_t w = d*64 + __builtin_ctzll(dirty);
+      counter.add(w, flags_[w], counts);
+      dirty &= dirty - 1;
     }
   }
 }
 
+void EvsManager::count()
+{
+  add_to_counter(counter_, counts_);
+}
+
 void EvsManager::count_completed()
 {
-  for (auto& e: data_) {
-    if (e.second.flag) {
-      ++(e.second.counts_ok);
+  add_to_counter(counter_ok_, counts_ok_);
+}
+
+void EvsManager::flush_counts()
+{
+  counter_.flush(counts_);
+  counter_ok_.flush(counts_ok_);
+}
+
+EvsMap EvsManager::data() const
+{
+  EvsMap m;
+  for (const auto& e: handles_) {
+    const EvsHandle h = e.second;
+    EvsData& d = m[e.first];
+    d.flag = (flags_[word_index(h)] & bit_mask(h));
+    d.counts = counts(h);
+    d.counts_ok = counts_completed(h);
+  }
+  return m;
+}
+
+void EvsManager::restore_counts(const EvsMap& data)
+{
+  reset_all_counts();
+  for (const auto& e: data) {
+    EvsHandle h = handle(e.first);
+    if (h == invalid_handle) {
+      h = define(e.first);
     }
+    counts_[h] = e.second.counts;
+    counts_ok_[h] = e.second.counts_ok;
   }
 }
 
@@ -70,30 +289,48 @@ void EvsManager::print_summary() const
             << "        **************************************\n"
             << std::endl;
 
-  std::cout << "  Number of EVS : " << data_.size() << '\n'
+  std::vector<std::pair<std::string, EvsHandle>> sorted(handles_.begin(), handles_.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  std::cout << "  Number of EVS : " << sorted.size() << '\n'
             << "------------------------------------------------------------------------------\n"
             << "                 key                        |     counts     |   completed    \n"
             << "------------------------------------------------------------------------------\n";
-  for (auto& e: data_) {
+  for (auto& e: sorted) {
     std::cout << std::setw(44) << std::left << e.first << ' '
-              << std::setw(16) << std::right << e.second.counts << ' '
-              << std::setw(16) << std::right << e.second.counts_ok
+              << std::setw(16) << std::right << counts(e.second) << ' '
+              << std::setw(16) << std::right << counts_completed(e.second)
               << std::setw(0) << '\n';
   }
   std::cout << "------------------------------------------------------------------------------\n"
             << std::endl;
 }
 
+boost::property_tree::ptree EvsManager::summary_to_property_tree() const
+{
+  std::vector<std::pair<std::string, EvsHandle>> sorted(handles_.begin(), handles_.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  boost::property_tree::ptree pt;
+  for (auto& e: sorted) {
+    boost::property_tree::ptree pt_evs;
+    pt_evs.put("key", e.first);
+    pt_evs.put("counts", counts(e.second));
+    pt_evs.put("completed", counts_completed(e.second));
+    pt.push_back(std::make_pair("", std::move(pt_evs)));
+  }
+  return pt;
+}
+
 void EvsManager::merge(const EvsManager& r)
 {
-  for (const auto& evs: r.data()) {
-    const std::string& key = evs.first;
-    if (is_defined(key)) {
-      data_[key] += evs.second;
-    }
-    else {
-      data_[key] = evs.second;
+  for (const auto& e: r.handles_) {
+    const EvsHandle h = e.second;
+    if (!is_defined(h)) {
+      define_handle(e.first, h);
     }
+    counts_[h] += r.counts(h);
+    counts_ok_[h] += r.counts_completed(h);
   }
 }
 
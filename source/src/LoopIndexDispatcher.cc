@@ -0,0 +1,265 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "LoopIndexDispatcher.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace anlnext
+{
+
+LoopIndexDispatcher::~LoopIndexDispatcher() = default;
+
+void LoopIndexDispatcher::reset(long int num_loops, int num_chains,
+                                long int chunk_size, bool adaptive,
+                                bool work_stealing, long int first_index)
+{
+  next_index_ = first_index;
+  last_index_ = (num_loops < 0) ? std::numeric_limits<long int>::max() : num_loops;
+  num_chains_ = std::max(num_chains, 1);
+  chunk_size_ = std::max(chunk_size, 1L);
+  adaptive_ = adaptive && (num_loops >= 0);
+  work_stealing_ = work_stealing && (num_loops >= 0);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    returned_ranges_.clear();
+    has_returned_ranges_ = false;
+  }
+
+  queues_.clear();
+  if (work_stealing_) {
+    const long int num_indices = std::max(last_index_ - first_index, 0L);
+    const long int block = num_indices / num_chains_;
+    const long int extra = num_indices % num_chains_;
+    long int begin = first_index;
+    for (int i=0; i<num_chains_; i++) {
+      std::unique_ptr<ChainQueue> queue(new ChainQueue);
+      LoopIndexRange range;
+      range.begin = begin;
+      range.end = begin + block + ((i < extra) ? 1 : 0);
+      if (!range.empty()) {
+        queue->ranges.push_back(range);
+        queue->remaining = range.size();
+      }
+      begin = range.end;
+      queues_.push_back(std::move(queue));
+    }
+    next_index_ = last_index_;
+  }
+}
+
+long int LoopIndexDispatcher::chunk_size_at(long int index) const
+{
+  if (!adaptive_) {
+    return chunk_size_;
+  }
+
+  // guided scheduling: a chunk is at most a half of the fair share of the
+  // remaining indices, so that all chains finish at nearly the same time.
+  const long int remaining = last_index_ - index;
+  const long int guided = remaining / (2 * num_chains_);
+  return std::max(std::min(guided, chunk_size_), 1L);
+}
+
+bool LoopIndexDispatcher::take(int chain_index, LoopIndexRange& range)
+{
+  if (work_stealing_) {
+    ChainQueue& queue = *queues_[chain_index];
+    if (take_own(queue, range)) {
+      return true;
+    }
+    return steal(chain_index, range);
+  }
+
+  return take_shared(range);
+}
+
+bool LoopIndexDispatcher::take_shared(LoopIndexRange& range)
+{
+  if (has_returned_ranges_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!returned_ranges_.empty()) {
+      range = returned_ranges_.back();
+      returned_ranges_.pop_back();
+      has_returned_ranges_ = !returned_ranges_.empty();
+      return true;
+    }
+  }
+
+  long int begin = 0;
+  if (adaptive_) {
+    begin = next_index_.load(std::memory_order_relaxed);
+    long int size = chunk_size_at(begin);
+    while (begin < last_index_ &&
+           !next_index_.compare_exchange_weak(begin, begin+size, std::memory_order_relaxed)) {
+      size = chunk_size_at(begin);
+    }
+    range.end = std::min(begin+size, last_index_);
+  }
+  else {
+    begin = next_index_.fetch_add(chunk_size_, std::memory_order_relaxed);
+    range.end = (begin < last_index_-chunk_size_) ? (begin+chunk_size_) : last_index_;
+  }
+
+  range.begin = begin;
+  return !range.empty();
+}
+
+bool LoopIndexDispatcher::take_own(ChainQueue& queue, LoopIndexRange& range)
+{
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  while (!queue.ranges.empty()) {
+    LoopIndexRange& front = queue.ranges.front();
+    if (front.empty()) {
+      queue.ranges.pop_front();
+      continue;
+    }
+
+    long int size = chunk_size_;
+    if (adaptive_) {
+      size = std::max(std::min(queue.remaining/2, chunk_size_), 1L);
+    }
+    range.begin = front.begin;
+    range.end = std::min(front.begin+size, front.end);
+    front.begin = range.end;
+    if (front.empty()) {
+      queue.ranges.pop_front();
+    }
+    queue.remaining -= range.size();
+    return true;
+  }
+  return false;
+}
+
+bool LoopIndexDispatcher::steal(int chain_index, LoopIndexRange& range)
+{
+  ChainQueue& own = *queues_[chain_index];
+
+  while (true) {
+    int victim_index = -1;
+    long int victim_remaining = 0;
+    for (int i=0; i<num_chains_; i++) {
+      const long int remaining = queues_[i]->remaining;
+      if (i != chain_index && remaining > victim_remaining) {
+        victim_index = i;
+        victim_remaining = remaining;
+      }
+    }
+    if (victim_index < 0) {
+      return false;
+    }
+
+    LoopIndexRange stolen;
+    {
+      ChainQueue& victim = *queues_[victim_index];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.ranges.empty()) {
+        continue;
+      }
+
+      if (victim.ranges.size() > 1) {
+        stolen = victim.ranges.back();
+        victim.ranges.pop_back();
+      }
+      else {
+        // steal the upper half of the last range.
+        LoopIndexRange& last = victim.ranges.back();
+        const long int half = last.size() / 2;
+        if (half == 0) {
+          stolen = last;
+          victim.ranges.pop_back();
+        }
+        else {
+          stolen.begin = last.end - half;
+          stolen.end = last.end;
+          last.end = stolen.begin;
+        }
+      }
+      victim.remaining -= stolen.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.ranges.push_back(stolen);
+      own.remaining += stolen.size();
+      own.steals += 1;
+      own.stolen_indices += stolen.size();
+    }
+
+    if (take_own(own, range)) {
+      return true;
+    }
+  }
+}
+
+void LoopIndexDispatcher::give_back(int chain_index, const LoopIndexRange& range)
+{
+  if (range.empty()) {
+    return;
+  }
+
+  if (work_stealing_) {
+    // the chain gives it up, so the others will steal it.
+    ChainQueue& queue = *queues_[chain_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.ranges.push_front(range);
+    queue.remaining += range.size();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  returned_ranges_.push_back(range);
+  has_returned_ranges_ = true;
+}
+
+bool LoopIndexDispatcher::has_returned_ranges()
+{
+  if (work_stealing_) {
+    for (const auto& queue: queues_) {
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if (queue->remaining > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !returned_ranges_.empty();
+}
+
+long int LoopIndexDispatcher::number_of_steals(int chain_index) const
+{
+  if (chain_index < static_cast<int>(queues_.size())) {
+    return queues_[chain_index]->steals;
+  }
+  return 0;
+}
+
+long int LoopIndexDispatcher::number_of_stolen_indices(int chain_index) const
+{
+  if (chain_index < static_cast<int>(queues_.size())) {
+    return queues_[chain_index]->stolen_indices;
+  }
+  return 0;
+}
+
+} /* namespace anlnext */
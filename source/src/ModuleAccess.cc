@@ -19,17 +19,107 @@
 
 #include "ModuleAccess.hh"
 #include "BasicModule.hh"
+#include <functional>
+#include <utility>
 
 namespace anlnext
 {
 
+BasicModule* ModuleAccess::ModuleTable::find(const std::string& name) const
+{
+  if (slots_.empty()) {
+    return nullptr;
+  }
+  const std::size_t i = find_slot(name, std::hash<std::string>()(name));
+  return (i == npos) ? nullptr : slots_[i].module;
+}
+
+std::size_t ModuleAccess::ModuleTable::find_slot(const std::string& name, std::size_t hash) const
+{
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t i = hash & mask; ; i = (i+1) & mask) {
+    const Slot& slot = slots_[i];
+    if (slot.module == nullptr) {
+      return npos;
+    }
+    if (slot.hash == hash && slot.name == name) {
+      return i;
+    }
+  }
+}
+
+void ModuleAccess::ModuleTable::assign(const std::string& name, BasicModule* module)
+{
+  if ((size_+1)*4 > slots_.size()*3) {
+    rehash((slots_.size() < 16) ? 16 : slots_.size()*2);
+  }
+
+  const std::size_t hash = std::hash<std::string>()(name);
+  const std::size_t found = find_slot(name, hash);
+  if (found != npos) {
+    slots_[found].module = module;
+    return;
+  }
+
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t i = hash & mask;
+  while (slots_[i].module != nullptr) {
+    i = (i+1) & mask;
+  }
+  slots_[i].hash = hash;
+  slots_[i].name = name;
+  slots_[i].module = module;
+  ++size_;
+}
+
+void ModuleAccess::ModuleTable::erase(const std::string& name)
+{
+  if (slots_.empty()) {
+    return;
+  }
+  std::size_t i = find_slot(name, std::hash<std::string>()(name));
+  if (i == npos) {
+    return;
+  }
+
+  // backward-shift deletion, which keeps probe sequences without tombstones.
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t j = (i+1) & mask; slots_[j].module != nullptr; j = (j+1) & mask) {
+    const std::size_t k = slots_[j].hash & mask;
+    const bool movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+    if (movable) {
+      slots_[i] = std::move(slots_[j]);
+      slots_[j] = Slot();
+      i = j;
+    }
+  }
+  slots_[i] = Slot();
+  --size_;
+}
+
+void ModuleAccess::ModuleTable::rehash(std::size_t capacity)
+{
+  std::vector<Slot> old_slots;
+  old_slots.swap(slots_);
+  slots_.resize(capacity);
+  const std::size_t mask = capacity - 1;
+  for (Slot& slot: old_slots) {
+    if (slot.module != nullptr) {
+      std::size_t i = slot.hash & mask;
+      while (slots_[i].module != nullptr) {
+        i = (i+1) & mask;
+      }
+      slots_[i] = std::move(slot);
+    }
+  }
+}
+
 ModuleAccess::~ModuleAccess() = default;
 
 const BasicModule* ModuleAccess::get_module(const std::string& name) const
 {
-  ANLModuleMap::const_iterator it = module_map_.find(name);
-  if (it != std::end(module_map_)) {
-    const BasicModule* const m = it->second;
+  const BasicModule* const m = module_table_.find(name);
+  if (m != nullptr) {
     const Permission permission = m->access_permission();
     if (permission == Permission::full_access || permission == Permission::read_only_access) {
       return m;
@@ -46,9 +136,8 @@ const BasicModule* ModuleAccess::get_module(const std::string& name) const
 
 BasicModule* ModuleAccess::get_module_NC(const std::string& name) const
 {
-  ANLModuleMap::const_iterator it = module_map_.find(name);
-  if (it != std::end(module_map_)) {
-    BasicModule* const m = it->second;
+  BasicModule* const m = module_table_.find(name);
+  if (m != nullptr) {
     if (m->access_permission() == Permission::full_access) {
       return m;
     }
@@ -64,9 +153,8 @@ BasicModule* ModuleAccess::get_module_NC(const std::string& name) const
 
 const BasicModule* ModuleAccess::request_module(const std::string& name) const
 {
-  ANLModuleMap::const_iterator it = module_map_.find(name);
-  if (it != std::end(module_map_)) {
-    const BasicModule* const m = it->second;
+  const BasicModule* const m = module_table_.find(name);
+  if (m != nullptr) {
     const Permission permission = m->access_permission();
     if (permission == Permission::full_access || permission == Permission::read_only_access) {
       return m;
@@ -77,9 +165,8 @@ const BasicModule* ModuleAccess::request_module(const std::string& name) const
 
 BasicModule* ModuleAccess::request_module_NC(const std::string& name) const
 {
-  ANLModuleMap::const_iterator it = module_map_.find(name);
-  if (it != std::end(module_map_)) {
-    BasicModule* const m = it->second;
+  BasicModule* const m = module_table_.find(name);
+  if (m != nullptr) {
     if (m->access_permission() == Permission::full_access) {
       return m;
     }
@@ -96,10 +183,10 @@ void ModuleAccess::register_module(const std::string& name,
       case ConflictOption::yield:
         break;
       case ConflictOption::overwrite:
-        module_map_[name] = module;
+        module_table_.assign(name, module);
         break;
       case ConflictOption::remove:
-        module_map_.erase(name);
+        module_table_.erase(name);
         break;
       case ConflictOption::error:
         BOOST_THROW_EXCEPTION( ANLException((boost::format("Module ID or alias %s already exists.") % name).str()) );
@@ -111,7 +198,7 @@ void ModuleAccess::register_module(const std::string& name,
       case ConflictOption::remove:
         break;
       default:
-        module_map_[name] = module;
+        module_table_.assign(name, module);
     }
   }
 }
@@ -0,0 +1,115 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "OrderKeeper.hh"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif /* __linux__ */
+
+namespace anlnext
+{
+
+namespace
+{
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline void futex_wait(std::atomic<int32_t>* word, int32_t expected)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+#else
+  while (word->load() == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+inline void futex_wake_all(std::atomic<int32_t>* word)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<int32_t*>(word), FUTEX_WAKE_PRIVATE,
+          INT_MAX, nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
+
+} /* anonymous namespace */
+
+int OrderKeeper::default_spin_count()
+{
+  static const int count = (std::thread::hardware_concurrency() > 1) ? 2000 : 0;
+  return count;
+}
+
+void OrderKeeper::wait(long int index)
+{
+  const long int target = index - 1;
+  if (last_done_index_.load(std::memory_order_acquire) == target) {
+    return;
+  }
+
+  for (int i=0; i<spin_count_; i++) {
+    cpu_relax();
+    if (last_done_index_.load(std::memory_order_acquire) == target) {
+      return;
+    }
+  }
+
+  // Slots are shared only by indices differing by multiples of the number
+  // of slots; such a waiter just goes back to sleep after a spurious wakeup.
+  WaitSlot& s = slot(index);
+  s.waiters.fetch_add(1, std::memory_order_seq_cst);
+  while (true) {
+    const int32_t sequence = s.sequence.load(std::memory_order_seq_cst);
+    if (last_done_index_.load(std::memory_order_seq_cst) == target) {
+      break;
+    }
+    futex_wait(&s.sequence, sequence);
+  }
+  s.waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void OrderKeeper::send_done(long int index)
+{
+  last_done_index_.store(index, std::memory_order_seq_cst);
+
+  WaitSlot& s = slot(index+1);
+  if (s.waiters.load(std::memory_order_seq_cst) > 0) {
+    s.sequence.fetch_add(1, std::memory_order_seq_cst);
+    futex_wake_all(&s.sequence);
+  }
+}
+
+} /* namespace anlnext */
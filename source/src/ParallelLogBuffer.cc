@@ -0,0 +1,99 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "ParallelLogBuffer.hh"
+#include <cstdlib>
+
+namespace anlnext
+{
+
+thread_local std::string* ParallelLogBuffer::current_slot_ = nullptr;
+ParallelLogBuffer* ParallelLogBuffer::instance_ = nullptr;
+std::terminate_handler ParallelLogBuffer::previous_terminate_handler_ = nullptr;
+
+ParallelLogBuffer::ParallelLogBuffer(std::ostream& os, std::size_t num_slots)
+  : stream_(os), original_(os.rdbuf()), slots_(num_slots)
+{
+  stream_.rdbuf(this);
+  instance_ = this;
+  previous_terminate_handler_ = std::set_terminate(&ParallelLogBuffer::terminate_with_slot);
+}
+
+ParallelLogBuffer::~ParallelLogBuffer()
+{
+  std::set_terminate(previous_terminate_handler_);
+  instance_ = nullptr;
+  flush();
+  stream_.rdbuf(original_);
+}
+
+void ParallelLogBuffer::terminate_with_slot()
+{
+  // only the calling thread writes to its slot.
+  if (instance_ && current_slot_) {
+    std::lock_guard<std::mutex> lock(instance_->mutex_);
+    instance_->original_->sputn(current_slot_->data(), current_slot_->size());
+    instance_->original_->pubsync();
+  }
+  if (previous_terminate_handler_) {
+    previous_terminate_handler_();
+  }
+  std::abort();
+}
+
+void ParallelLogBuffer::flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::string& s: slots_) {
+    original_->sputn(s.data(), s.size());
+    s.clear();
+  }
+  original_->pubsync();
+}
+
+ParallelLogBuffer::int_type ParallelLogBuffer::overflow(int_type c)
+{
+  if (traits_type::eq_int_type(c, traits_type::eof())) {
+    return traits_type::not_eof(c);
+  }
+  const char ch = traits_type::to_char_type(c);
+  xsputn(&ch, 1);
+  return c;
+}
+
+std::streamsize ParallelLogBuffer::xsputn(const char* s, std::streamsize n)
+{
+  if (current_slot_) {
+    current_slot_->append(s, n);
+    return n;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return original_->sputn(s, n);
+}
+
+int ParallelLogBuffer::sync()
+{
+  if (current_slot_) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return original_->pubsync();
+}
+
+} /* namespace anlnext */
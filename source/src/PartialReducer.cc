@@ -0,0 +1,156 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "PartialReducer.hh"
+#include <chrono>
+
+namespace anlnext
+{
+
+PartialReducer::~PartialReducer()
+{
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_requested_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+}
+
+void PartialReducer::reset(int num_chains, long int period, double interval)
+{
+  if (num_chains != num_chains_) {
+    slots_.reset(new Slot[num_chains]);
+    num_chains_ = num_chains;
+  }
+  for (int i=0; i<num_chains_; i++) {
+    slots_[i].generation = 0;
+    slots_[i].pending.store(false, std::memory_order_relaxed);
+  }
+  period_ = (period > 0) ? period : 0;
+  interval_ = (interval > 0.0) ? interval : 0.0;
+  generation_.store(0, std::memory_order_relaxed);
+  failed_.store(false, std::memory_order_relaxed);
+  num_merged_deltas_ = 0;
+  submitted_ = false;
+  stop_requested_ = false;
+  status_ = AS_OK;
+  exception_ = nullptr;
+  active_ = false;
+}
+
+void PartialReducer::start(MergeFunction merge)
+{
+  if (period_ == 0 && interval_ == 0.0) { return; }
+  active_ = true;
+  thread_ = std::thread(&PartialReducer::run, this, std::move(merge));
+}
+
+ANLStatus PartialReducer::stop()
+{
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_requested_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+  active_ = false;
+
+  if (exception_) {
+    std::exception_ptr e = exception_;
+    exception_ = nullptr;
+    std::rethrow_exception(e);
+  }
+  return status_;
+}
+
+void PartialReducer::submit(int chain)
+{
+  Slot& slot = slots_[chain];
+  slot.generation = generation_.load(std::memory_order_relaxed);
+  slot.pending.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    submitted_ = true;
+  }
+  cv_.notify_all();
+}
+
+void PartialReducer::run(MergeFunction merge)
+{
+  using clock = std::chrono::steady_clock;
+  const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(interval_));
+  auto time_next = clock::now() + period;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    auto ready = [this]{ return submitted_ || stop_requested_; };
+    if (interval_ > 0.0) {
+      if (!cv_.wait_until(lock, time_next, ready)) {
+        generation_.fetch_add(1, std::memory_order_relaxed);
+        time_next += period;
+        continue;
+      }
+    }
+    else {
+      cv_.wait(lock, ready);
+    }
+
+    submitted_ = false;
+    merge_pending(merge, lock);
+    // a chain may submit while the lock is released in merge_pending();
+    // its delta is merged in the next sweep before stopping.
+    if (stop_requested_ && !submitted_) { break; }
+  }
+}
+
+void PartialReducer::merge_pending(const MergeFunction& merge, std::unique_lock<std::mutex>& lock)
+{
+  for (int i=0; i<num_chains_; i++) {
+    Slot& slot = slots_[i];
+    if (!slot.pending.load(std::memory_order_acquire)) { continue; }
+
+    if (!failed_.load(std::memory_order_relaxed)) {
+      lock.unlock();
+      ANLStatus status = AS_OK;
+      try {
+        status = merge(i);
+      }
+      catch (...) {
+        exception_ = std::current_exception();
+        status = ANLStatus::critical_error_to_finalize_from_exception;
+      }
+      lock.lock();
+      if (status == AS_OK) {
+        ++num_merged_deltas_;
+      }
+      else {
+        if (status_ == AS_OK) { status_ = status; }
+        failed_.store(true, std::memory_order_relaxed);
+      }
+    }
+    slot.pending.store(false, std::memory_order_release);
+  }
+}
+
+} /* namespace anlnext */
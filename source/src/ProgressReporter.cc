@@ -0,0 +1,118 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "ProgressReporter.hh"
+#include <algorithm>
+#include <boost/format.hpp>
+
+namespace anlnext
+{
+
+ProgressReporter::~ProgressReporter()
+{
+  stop();
+}
+
+void ProgressReporter::reset(int num_counters, long int num_events)
+{
+  if (num_counters != num_counters_) {
+    counters_.reset(new Counter[num_counters]);
+    num_counters_ = num_counters;
+  }
+  for (int i=0; i<num_counters_; i++) {
+    counters_[i].count.store(0, std::memory_order_relaxed);
+  }
+  num_events_ = num_events;
+}
+
+void ProgressReporter::start(double interval, std::ostream& os)
+{
+  stop();
+  stop_requested_ = false;
+  thread_ = std::thread(&ProgressReporter::run, this, interval, std::ref(os));
+}
+
+void ProgressReporter::stop()
+{
+  if (!thread_.joinable()) { return; }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void ProgressReporter::run(double interval, std::ostream& os)
+{
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval));
+  const auto time_start = std::chrono::steady_clock::now();
+  auto time_next = time_start + period;
+  auto time_previous = time_start;
+  std::vector<long int> previous(num_counters_, 0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!cv_.wait_until(lock, time_next, [this]{ return stop_requested_; })) {
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - time_start).count();
+    const double sampling_time = std::chrono::duration<double>(now - time_previous).count();
+    report(elapsed, sampling_time, previous, os);
+    time_previous = now;
+    time_next += period;
+  }
+}
+
+void ProgressReporter::report(double elapsed, double interval,
+                              std::vector<long int>& previous,
+                              std::ostream& os)
+{
+  long int total = 0;
+  long int total_previous = 0;
+  std::vector<double> rates(num_counters_, 0.0);
+  for (int i=0; i<num_counters_; i++) {
+    const long int c = count(i);
+    total += c;
+    total_previous += previous[i];
+    rates[i] = (c - previous[i]) / interval;
+    previous[i] = c;
+  }
+  const double rate = (total - total_previous) / interval;
+
+  os << boost::format("Progress: %10d") % total;
+  if (num_events_ > 0) {
+    os << boost::format(" / %d (%5.1f%%)") % num_events_ % (100.0*total/num_events_);
+  }
+  os << boost::format(" | %10.1f events/s | elapsed %8.1f s") % rate % elapsed;
+  if (num_events_ > 0 && rate > 0.0) {
+    os << boost::format(" | ETA %8.1f s") % ((num_events_ - total)/rate);
+  }
+
+  if (num_counters_ > 1) {
+    const double max_rate = *std::max_element(rates.begin(), rates.end());
+    const double mean_rate = rate / num_counters_;
+    os << boost::format(" | imbalance %5.2f") % ((mean_rate > 0.0) ? max_rate/mean_rate : 1.0);
+    os << "\n  chain rates [events/s]:";
+    for (double r: rates) {
+      os << boost::format(" %.1f") % r;
+    }
+  }
+  os << std::endl;
+}
+
+} /* namespace anlnext */
@@ -0,0 +1,140 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "ReorderBuffer.hh"
+
+#include <algorithm>
+
+namespace anlnext
+{
+
+ReorderBuffer::~ReorderBuffer() = default;
+
+void ReorderBuffer::reset(int num_chains, int num_producers, long int first_index)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_chains_.clear();
+  for (int i=num_chains-1; i>=0; i--) {
+    free_chains_.push_back(i);
+  }
+  num_live_chains_ = num_chains;
+  entries_.assign(num_chains, Entry());
+  occupied_.assign(num_chains, false);
+  next_index_ = first_index;
+  num_producers_ = num_producers;
+  aborted_ = false;
+}
+
+int ReorderBuffer::acquire_chain()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  chain_cv_.wait(lock, [this](){
+      return (aborted_ || !free_chains_.empty() || num_live_chains_ == 0);
+    });
+
+  if (aborted_ || free_chains_.empty()) {
+    return -1;
+  }
+
+  const int chain = free_chains_.back();
+  free_chains_.pop_back();
+  return chain;
+}
+
+void ReorderBuffer::release_chain(int chain)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_chains_.push_back(chain);
+  }
+  chain_cv_.notify_one();
+}
+
+void ReorderBuffer::retire_chain(int)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_live_chains_;
+  }
+  chain_cv_.notify_all();
+}
+
+void ReorderBuffer::retire_free_chain(int chain)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(std::begin(free_chains_), std::end(free_chains_), chain);
+    if (it == std::end(free_chains_)) {
+      return;
+    }
+    free_chains_.erase(it);
+    --num_live_chains_;
+  }
+  chain_cv_.notify_all();
+}
+
+void ReorderBuffer::push(const Entry& entry)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::size_t slot = entry.index % entries_.size();
+    entries_[slot] = entry;
+    occupied_[slot] = true;
+  }
+  entry_cv_.notify_one();
+}
+
+bool ReorderBuffer::pop_next(Entry& entry)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  const std::size_t slot = next_index_ % entries_.size();
+  entry_cv_.wait(lock, [this, slot](){
+      return (aborted_ || occupied_[slot] || num_producers_ == 0);
+    });
+
+  if (aborted_ || !occupied_[slot]) {
+    return false;
+  }
+
+  entry = entries_[slot];
+  occupied_[slot] = false;
+  ++next_index_;
+  return true;
+}
+
+void ReorderBuffer::close_producer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_producers_;
+  }
+  entry_cv_.notify_all();
+}
+
+void ReorderBuffer::abort()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = true;
+  }
+  chain_cv_.notify_all();
+  entry_cv_.notify_all();
+}
+
+} /* namespace anlnext */
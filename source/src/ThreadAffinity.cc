@@ -0,0 +1,206 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "ThreadAffinity.hh"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <tuple>
+#include <boost/format.hpp>
+#include "ANLException.hh"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace anlnext
+{
+
+namespace
+{
+
+struct CPUTopology
+{
+  int cpu = 0;
+  int package = 0;
+  int core = 0;
+  int sibling_rank = 0; // rank among the hardware threads of the core
+};
+
+int read_topology_value(int cpu, const std::string& name)
+{
+  std::ifstream fin((boost::format("/sys/devices/system/cpu/cpu%d/topology/%s") % cpu % name).str());
+  int value = 0;
+  if (fin >> value) {
+    return value;
+  }
+  return 0;
+}
+
+std::vector<CPUTopology> read_topology(const std::vector<int>& cpus)
+{
+  std::vector<CPUTopology> topology;
+  std::map<std::pair<int, int>, int> num_siblings;
+  for (int cpu: cpus) {
+    CPUTopology t;
+    t.cpu = cpu;
+    t.package = read_topology_value(cpu, "physical_package_id");
+    t.core = read_topology_value(cpu, "core_id");
+    t.sibling_rank = num_siblings[std::make_pair(t.package, t.core)]++;
+    topology.push_back(t);
+  }
+  return topology;
+}
+
+} /* anonymous namespace */
+
+void ThreadAffinity::set_policy(const std::string& name)
+{
+  if (name == "none") {
+    policy_ = AffinityPolicy::none;
+  }
+  else if (name == "compact") {
+    policy_ = AffinityPolicy::compact;
+  }
+  else if (name == "scatter") {
+    policy_ = AffinityPolicy::scatter;
+  }
+  else if (name == "explicit") {
+    policy_ = AffinityPolicy::explicit_list;
+  }
+  else {
+    BOOST_THROW_EXCEPTION( ANLException((boost::format("Unknown affinity policy ===> %s") % name).str()) );
+  }
+}
+
+std::string ThreadAffinity::policy_name() const
+{
+  switch (policy_) {
+  case AffinityPolicy::compact: return "compact";
+  case AffinityPolicy::scatter: return "scatter";
+  case AffinityPolicy::explicit_list: return "explicit";
+  default: return "none";
+  }
+}
+
+void ThreadAffinity::setup()
+{
+  cpu_order_.clear();
+  if (policy_ == AffinityPolicy::none) {
+    return;
+  }
+
+  const std::vector<int> cpus = available_cpus();
+
+  if (policy_ == AffinityPolicy::explicit_list) {
+    if (cpu_list_.empty()) {
+      BOOST_THROW_EXCEPTION( ANLException("CPU list is empty for the explicit affinity policy") );
+    }
+    for (int cpu: cpu_list_) {
+      if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+        BOOST_THROW_EXCEPTION( ANLException((boost::format("CPU is not available ===> %d") % cpu).str()) );
+      }
+    }
+    cpu_order_ = cpu_list_;
+    return;
+  }
+
+  std::vector<CPUTopology> topology = read_topology(cpus);
+  if (policy_ == AffinityPolicy::compact) {
+    std::sort(topology.begin(), topology.end(),
+              [](const CPUTopology& a, const CPUTopology& b) {
+                return std::tie(a.package, a.core, a.sibling_rank) < std::tie(b.package, b.core, b.sibling_rank);
+              });
+    for (const CPUTopology& t: topology) {
+      cpu_order_.push_back(t.cpu);
+    }
+  }
+  else {
+    // the first hardware threads of all the cores come first, and the
+    // packages are taken in turn.
+    std::map<int, std::vector<CPUTopology>> packages;
+    for (const CPUTopology& t: topology) {
+      packages[t.package].push_back(t);
+    }
+    for (auto& p: packages) {
+      std::sort(p.second.begin(), p.second.end(),
+                [](const CPUTopology& a, const CPUTopology& b) {
+                  return std::tie(a.sibling_rank, a.core) < std::tie(b.sibling_rank, b.core);
+                });
+    }
+    for (std::size_t i=0; cpu_order_.size()<topology.size(); i++) {
+      for (auto& p: packages) {
+        if (i < p.second.size()) {
+          cpu_order_.push_back(p.second[i].cpu);
+        }
+      }
+    }
+  }
+}
+
+int ThreadAffinity::cpu(int thread_index) const
+{
+  if (cpu_order_.empty()) {
+    return -1;
+  }
+  return cpu_order_[thread_index % cpu_order_.size()];
+}
+
+bool ThreadAffinity::pin_current_thread(int thread_index) const
+{
+  const int c = cpu(thread_index);
+  if (c < 0) {
+    return false;
+  }
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(c, &cpuset);
+  return (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0);
+#else
+  return false;
+#endif
+}
+
+std::vector<int> ThreadAffinity::available_cpus()
+{
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+    for (int i=0; i<CPU_SETSIZE; i++) {
+      if (CPU_ISSET(i, &cpuset)) {
+        cpus.push_back(i);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const int n = std::max(1u, std::thread::hardware_concurrency());
+    for (int i=0; i<n; i++) {
+      cpus.push_back(i);
+    }
+  }
+  return cpus;
+}
+
+} /* namespace anlnext */
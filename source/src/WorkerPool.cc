@@ -0,0 +1,120 @@
+/*************************************************************************
+ *                                                                       *
+ * Copyright (c) 2011 Hirokazu Odaka                                     *
+ *                                                                       *
+ * This program is free software: you can redistribute it and/or modify  *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * This program is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                       *
+ *************************************************************************/
+
+#include "WorkerPool.hh"
+
+namespace anlnext
+{
+
+WorkerPool::~WorkerPool()
+{
+  stop();
+}
+
+void WorkerPool::start(int num_workers, std::function<void(int)> initializer)
+{
+  stop();
+  stopping_ = false;
+  workers_ = std::vector<Worker>(num_workers);
+  for (int i=0; i<num_workers; i++) {
+    workers_[i].thread = std::thread(&WorkerPool::run, this, i, initializer);
+  }
+}
+
+void WorkerPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_task_.notify_all();
+  for (Worker& w: workers_) {
+    if (w.thread.joinable()) {
+      w.thread.join();
+    }
+  }
+  workers_.clear();
+}
+
+void WorkerPool::run_all(const std::function<void(int)>& task)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int i=0; i<size(); i++) {
+    workers_[i].task = [&task, i]() { task(i); };
+    workers_[i].has_task = true;
+  }
+  num_pending_ = size();
+  cv_task_.notify_all();
+  wait_for_tasks(lock);
+}
+
+void WorkerPool::run_one(int index, const std::function<void()>& task)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  workers_[index].task = task;
+  workers_[index].has_task = true;
+  num_pending_ = 1;
+  cv_task_.notify_all();
+  wait_for_tasks(lock);
+}
+
+void WorkerPool::wait_for_tasks(std::unique_lock<std::mutex>& lock)
+{
+  cv_done_.wait(lock, [this]{ return num_pending_ == 0; });
+  if (exception_) {
+    std::exception_ptr e = exception_;
+    exception_ = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+void WorkerPool::run(int index, std::function<void(int)> initializer)
+{
+  if (initializer) {
+    initializer(index);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_task_.wait(lock, [this, index]{ return stopping_ || workers_[index].has_task; });
+    if (!workers_[index].has_task) {
+      break;
+    }
+
+    std::function<void()> task = std::move(workers_[index].task);
+    workers_[index].has_task = false;
+    lock.unlock();
+    std::exception_ptr e;
+    try {
+      task();
+    }
+    catch (...) {
+      e = std::current_exception();
+    }
+    lock.lock();
+    if (e && !exception_) {
+      exception_ = e;
+    }
+    if (--num_pending_ == 0) {
+      cv_done_.notify_all();
+    }
+  }
+}
+
+} /* namespace anlnext */